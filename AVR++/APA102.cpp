@@ -0,0 +1,194 @@
+#pragma once
+
+/**
+ * @file APA102.cpp
+ * @author Cameron Tacklind <cameron@tacklind.com>
+ * @brief The implementation of the APA102 class
+ * @note This file is part of the AVR++ library.
+ *
+ * @see The comments in APA102.hpp for more information on the internal workings of this implementation.
+ */
+
+#include "APA102.hpp"
+
+template <Basic::u1 ClockDivider>
+typename AVR::APA102<ClockDivider>::RGB const *AVR::APA102<ClockDivider>::pixel;
+
+template <Basic::u1 ClockDivider>
+Basic::u2 AVR::APA102<ClockDivider>::pixelsLeft;
+
+template <Basic::u1 ClockDivider>
+Basic::u2 AVR::APA102<ClockDivider>::zerosLeft;
+
+template <Basic::u1 ClockDivider>
+Basic::u2 AVR::APA102<ClockDivider>::endZeros;
+
+template <Basic::u1 ClockDivider>
+Basic::u1 AVR::APA102<ClockDivider>::phase;
+
+template <Basic::u1 ClockDivider>
+Basic::u1 AVR::APA102<ClockDivider>::pixelHeader;
+
+template <Basic::u1 ClockDivider>
+volatile typename AVR::APA102<ClockDivider>::Stage AVR::APA102<ClockDivider>::stage = Stage::Done;
+
+template <Basic::u1 ClockDivider>
+void AVR::APA102<ClockDivider>::init() {
+#ifdef __AVR_ATmega32U4__
+  // SS must be an output, or pulling it low would drop the SPI out of Master mode
+  SPI::SS::output();
+  SPI::SCLK::output();
+  SPI::MOSI::output();
+#else
+  // TODO: Support more chips here
+#error "Unsupported MCU"
+#endif
+
+  // Mode 0, MSB first
+  SPI::CRt cr;
+  cr.byte = 0;
+  cr.Divider = divider;
+  cr.Master = true;
+  cr.Enable = true;
+  SPI::CR->byte = cr.byte;
+
+  SPI::SR->byte = doubleSpeed;
+}
+
+template <Basic::u1 ClockDivider>
+void AVR::APA102<ClockDivider>::sendZeros(u2 count) {
+  while (count--) {
+    write(0);
+    wait();
+  }
+}
+
+template <Basic::u1 ClockDivider>
+void AVR::APA102<ClockDivider>::setLEDs(RGB const *leds, u2 pixels, u1 brightness) {
+  while (isSending())
+    ;
+
+  sendZeros(StartBytes);
+
+  u1 const h = header(brightness);
+
+  for (u2 i = pixels; i; i--) {
+    write(h);
+
+    // Load the pixel while its header is shifting out
+    RGB const p = *leds++;
+
+    wait();
+    write(p.b);
+    wait();
+    write(p.g);
+    wait();
+    write(p.r);
+    wait();
+  }
+
+  sendZeros(EndBytes(pixels));
+}
+
+template <Basic::u1 ClockDivider>
+void AVR::APA102<ClockDivider>::setLEDs(RGB const *leds, u1 const *brightness, u2 pixels) {
+  while (isSending())
+    ;
+
+  sendZeros(StartBytes);
+
+  u1 h = pixels ? header(*brightness++) : 0;
+
+  for (u2 i = pixels; i; i--) {
+    write(h);
+
+    // Load the pixel while its header is shifting out
+    RGB const p = *leds++;
+
+    wait();
+    write(p.b);
+
+    // And the next header while blue is
+    if (i != 1) h = header(*brightness++);
+
+    wait();
+    write(p.g);
+    wait();
+    write(p.r);
+    wait();
+  }
+
+  sendZeros(EndBytes(pixels));
+}
+
+template <Basic::u1 ClockDivider>
+void AVR::APA102<ClockDivider>::setLEDsAsync(RGB const *leds, u2 pixels, u1 brightness) {
+  while (isSending())
+    ;
+
+  pixel = leds;
+  pixelsLeft = pixels;
+  zerosLeft = StartBytes - 1;
+  endZeros = EndBytes(pixels);
+  phase = 0;
+  pixelHeader = header(brightness);
+  stage = Stage::Start;
+
+  // A blocking `setLEDs()` leaves SPIF set. Writing SPDR clears it, so the interrupt waits for this byte to be out.
+  write(0);
+
+  // Every other byte is written by `interrupt()`
+  SPI::CR->InterruptEnable = true;
+}
+
+template <Basic::u1 ClockDivider>
+bool AVR::APA102<ClockDivider>::interrupt() {
+  switch (stage) {
+  case Stage::Start:
+    if (zerosLeft) {
+      zerosLeft--;
+      write(0);
+      return false;
+    }
+
+    stage = Stage::Pixels;
+    [[fallthrough]];
+
+  case Stage::Pixels:
+    if (pixelsLeft) {
+      RGB const &p = *pixel;
+      u1 const ph = phase;
+
+      write(ph == 0 ? pixelHeader : ph == 1 ? p.b : ph == 2 ? p.g : p.r);
+
+      if (ph == 3) {
+        phase = 0;
+        pixel++;
+        pixelsLeft--;
+      } else {
+        phase = ph + 1;
+      }
+      return false;
+    }
+
+    stage = Stage::End;
+    zerosLeft = endZeros;
+    [[fallthrough]];
+
+  case Stage::End:
+    if (zerosLeft) {
+      zerosLeft--;
+      write(0);
+      return false;
+    }
+
+    SPI::CR->InterruptEnable = false;
+    stage = Stage::Done;
+    return true;
+
+  case Stage::Done:
+    break;
+  }
+
+  return false;
+}
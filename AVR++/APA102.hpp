@@ -0,0 +1,154 @@
+#pragma once
+
+/**
+ * @brief APA102 and SK9822 (clocked) LEDs over the hardware SPI
+ * @file APA102.hpp
+ * @author Cameron Tacklind <cameron@tacklind.com>
+ *
+ * These LEDs take a clock along with the data, so there's no pulse timing to hold. The SPI can run them at F_CPU / 2.
+ *
+ * Each update is a start frame of 32 0 bits, then 4 bytes per pixel, then an end frame:
+ *
+ *     111 + 5 bit brightness    blue    green    red
+ *
+ * Data is passed along one pixel per clock edge, so the end frame has to keep clocking, at least half a bit per pixel,
+ * for the last pixels to get theirs. SK9822 also needs 32 more 0 bits to latch. `EndBytes` covers both.
+ *
+ * Pixels are the same `RGB` as `WS2812`, so the same frame buffers (and `WS2812Color`) work for both.
+ *
+ * `setLEDs()` writes `SPDR` in a tight loop, getting the next byte ready while the last one shifts out. At F_CPU / 2,
+ * that's one byte per 16 cycles plus the SPIF polling. `setLEDsAsync()` uses the SPI interrupt instead. The SPI isn't
+ * buffered, so each byte waits for the interrupt to be serviced. It's much slower, but the main loop keeps running.
+ * The interrupt vector is left to the user, like `DShotAsync`.
+ *
+ * On the ATmega32U4, data is on MOSI (PB2) and the clock on SCLK (PB1). SS (PB0) is made an output so the SPI stays in
+ * Master mode.
+ *
+ * Usage:
+ *
+ * ```main.cpp
+ * #include <AVR++/APA102.cpp> // Yes, a cpp file
+ *
+ * using LEDs = AVR::APA102<>;
+ * template class AVR::APA102<>;
+ *
+ * ISR(SPI_STC_vect) { LEDs::interrupt(); } // Only for setLEDsAsync(). Returns true when it's done.
+ *
+ * LEDs::RGB strip[300];
+ *
+ * int main() {
+ *   LEDs::init();
+ *
+ *   while (true) {
+ *     LEDs::setLEDs(strip, 300);
+ *
+ *     // Dimmer, in hardware. Colors keep their full 8 bits.
+ *     LEDs::setLEDs(strip, 300, 4);
+ *   }
+ * }
+ * ```
+ */
+
+#include "SPI.hpp"
+#include "WS2812Pixels.hpp"
+#include "basicTypes.hpp"
+
+namespace AVR {
+using namespace Basic;
+
+/**
+ * @tparam ClockDivider F_CPU / SPI clock. 2, 4, 8, 16, 32, 64, or 128. (2)
+ */
+template <u1 ClockDivider = 2>
+class APA102 {
+  static_assert(ClockDivider == 2 || ClockDivider == 4 || ClockDivider == 8 || ClockDivider == 16 ||
+                    ClockDivider == 32 || ClockDivider == 64 || ClockDivider == 128,
+                "The SPI can only divide F_CPU by 2, 4, 8, 16, 32, 64, or 128");
+
+public:
+  using RGB = WS2812Pixels::RGB;
+
+  static constexpr u1 MaxBrightness = 31;
+  static constexpr u1 StartBytes = 4;
+
+  /**
+   * Half a clock per pixel, rounded up to bytes, plus 4 bytes for SK9822 to latch
+   */
+  static constexpr u2 EndBytes(u2 pixels) { return (pixels + 15) / 16 + 4; }
+
+  static constexpr u1 header(u1 brightness) { return 0b11100000 | (brightness & MaxBrightness); }
+
+protected:
+  // SPI2X doubles the rate of every SPR setting, which is why there's one more divider than SPR values
+  static constexpr bool doubleSpeed = ClockDivider == 2 || ClockDivider == 8 || ClockDivider == 32;
+  static constexpr u1 divider = ClockDivider <= 4 ? 0 : ClockDivider <= 16 ? 1 : ClockDivider <= 64 ? 2 : 3;
+
+  enum class Stage : u1 { Start, Pixels, End, Done };
+
+  // State for `interrupt()`
+  static RGB const *pixel;
+  static u2 pixelsLeft;
+  static u2 zerosLeft;
+  static u2 endZeros;
+  static u1 phase;
+  static u1 pixelHeader;
+  static volatile Stage stage;
+
+  static inline void write(u1 b) { *SPI::DR = b; }
+  static inline void wait() {
+    while (!SPI::SR->InterruptFlag)
+      ;
+  }
+
+  static void sendZeros(u2 count);
+
+public:
+  /**
+   * @brief Set up the SPI in Master mode and its pins
+   */
+  static void init();
+
+  /**
+   * @brief Send pixels and wait until the end frame is out
+   *
+   * @param leds The pixels to send
+   * @param pixels How many
+   * @param brightness The 5 bit hardware brightness of every pixel, 0 to `MaxBrightness`
+   */
+  static void setLEDs(RGB const *leds, u2 pixels, u1 brightness = MaxBrightness);
+
+  /**
+   * @brief Like `setLEDs()`, but with each pixel's own 5 bit brightness
+   *
+   * @param brightness One per pixel, 0 to `MaxBrightness`
+   */
+  static void setLEDs(RGB const *leds, u1 const *brightness, u2 pixels);
+
+  /**
+   * @brief Start sending pixels and return right away
+   *
+   * Waits for the previous pixels, if any, to be sent first. Global interrupts must be enabled.
+   *
+   * @param leds Must not change until `isSending()` is false
+   */
+  static void setLEDsAsync(RGB const *leds, u2 pixels, u1 brightness = MaxBrightness);
+
+  /**
+   * @return true while an async update is still being sent
+   */
+  inline static bool isSending() { return stage != Stage::Done; }
+
+  /**
+   * Call this from the SPI Serial Transfer Complete ISR:
+   * ```C++
+   * ISR(SPI_STC_vect) { LEDs::interrupt(); }
+   * ```
+   *
+   * It's inlined and makes no calls, so the ISR only saves the registers it uses.
+   *
+   * @return true once the end frame is out
+   */
+  static inline bool interrupt() __attribute__((always_inline));
+};
+
+}; // namespace AVR
@@ -13,6 +13,7 @@
  */
 
 #include "BDShot.hpp"
+#include "BDShotTiming.hpp"
 #include "Const.hpp"
 #include "Core.hpp"
 #include "GCR.hpp"
@@ -42,6 +43,16 @@ static inline void setCounter(u1 value) {
   TCNT0 = value;
 }
 
+static inline u1 getCounter() {
+  if (AssemblyComments) asm("; getCounter()");
+  return TCNT0;
+}
+
+static inline u1 getFlags() {
+  if (AssemblyComments) asm("; getFlags()");
+  return TIFR0;
+}
+
 static inline void enableOverflowShortInterrupt() {
   if (AssemblyComments) asm("; enableOverflowShortInterrupt()");
   TIMSK0 = BitOverflowShortFlagMask;
@@ -62,6 +73,11 @@ static inline void clearOverflowMaxFlag() {
   TIFR0 |= BitOverflowMaxFlagMask;
 }
 
+static inline bool hasOverflowShortFlagged() {
+  if (AssemblyComments) asm("; hasOverflowShortFlagged()");
+  return TIFR0 & BitOverflowShortFlagMask;
+}
+
 static inline bool hasOverflowMaxFlagged() {
   if (AssemblyComments) asm("; hasOverflowMaxFlagged()");
   return TIFR0 & BitOverflowMaxFlagMask;
@@ -100,11 +116,16 @@ static inline void stop() {
   TCCR0B = 0;
 }
 
+static inline void setShortPeriod(u1 shortPeriod) {
+  if (AssemblyComments) asm("; setShortPeriod(u1 shortPeriod)");
+  // Set TOP value
+  OCR0A = shortPeriod - 1;
+}
+
 static inline void init(u1 shortPeriod) {
   if (AssemblyComments) asm("; Setup Timer");
 
-  // Set TOP value
-  OCR0A = shortPeriod - 1;
+  setShortPeriod(shortPeriod);
 
   // Set up timer that we use internally
   TIMSK0 = 0; // Ensure timer interrupts are disabled
@@ -115,6 +136,9 @@ static inline void init(u1 shortPeriod) {
 } // namespace DShot
 } // namespace AVR
 
+template <AVR::Ports Port, int Pin, AVR::DShot::Speeds Speed>
+AVR::DShot::BootloaderDeadline AVR::DShot::BDShot<Port, Pin, Speed>::bootloader;
+
 template <AVR::Ports Port, int Pin, AVR::DShot::Speeds Speed>
 void AVR::DShot::BDShot<Port, Pin, Speed>::exitBootloader() {
   if (AssemblyComments) asm("; Waiting for bootloader exit");
@@ -123,7 +147,7 @@ void AVR::DShot::BDShot<Port, Pin, Speed>::exitBootloader() {
   Parent::IO::clr();
   Parent::IO::output();
 
-  // TODO: This is a long delay. Allow other things to happen while we wait.
+  // See startExitBootloader() to not block
   _delay_ms(BDShotConfig::exitBootloaderDelay);
 
   if (AssemblyComments) asm("; Done waiting for bootloader exit");
@@ -132,6 +156,31 @@ void AVR::DShot::BDShot<Port, Pin, Speed>::exitBootloader() {
   Parent::IO::set();
 }
 
+template <AVR::Ports Port, int Pin, AVR::DShot::Speeds Speed>
+void AVR::DShot::BDShot<Port, Pin, Speed>::startExitBootloader(u2 nowMs) {
+  if (AssemblyComments) asm("; Start waiting for bootloader exit");
+
+  // Output needs to be low long enough to get out of bootloader and start main program
+  Parent::IO::clr();
+  Parent::IO::output();
+
+  bootloader.start(nowMs);
+}
+
+template <AVR::Ports Port, int Pin, AVR::DShot::Speeds Speed>
+bool AVR::DShot::BDShot<Port, Pin, Speed>::pollExitBootloader(u2 nowMs) {
+  if (bootloader.isWaiting()) {
+    if (!bootloader.poll(nowMs)) return false;
+
+    if (AssemblyComments) asm("; Done waiting for bootloader exit");
+
+    // Set output high
+    Parent::IO::set();
+  }
+
+  return true;
+}
+
 template <AVR::Ports Port, int Pin, AVR::DShot::Speeds Speed>
 void AVR::DShot::BDShot<Port, Pin, Speed>::init() {
   BDShotTimer::init(Periods::delayPeriodTicks);
@@ -244,157 +293,44 @@ AVR::DShot::Response AVR::DShot::BDShot<Port, Pin, Speed>::getResponse() {
 
   using namespace BDShotConfig;
 
-  // These are probably defunct
-  static_assert(Periods::delayPeriodTicks == 43, "delayPeriodTicks is not what we expect!");
-  static_assert(Periods::delayHalfPeriodTicks == 21, "delayHalfPeriodTicks is not what we expect!");
-
   // We're expecting 4 nibbles in the response, each encoded with GCR
   // We don't count the extra bit because it's handled manually as it's the trigger to start reading the response and is
   // *always* 0.
   static constexpr unsigned expectedNibbles = 4;
   static constexpr Basic::u1 ExpectedBits = expectedNibbles * GCR::inBits;
 
-  constexpr unsigned responseTimeoutTicks = (((long long)(F_CPU)) * responseTimeout) / 1e6;
-
-  /**
-   * Number of ticks from timer overflow to when we execute the instruction that samples the pin's input state.
-   *
-   * This comes mostly from 3 separate places:
-   * - The AVR datasheet which specified ISR handling takes 5 clock cycles to execute.
-   * - The de facto standard JMP table as the first instructions in the ISR (could be eliminated with a custom .init)
-   * - Other instructions in the ISR before sampling the pin into a temp register
-   */
-  constexpr unsigned ticksFromOverflowToISRSample =
-      AVR::Core::Ticks::Hardware::ISR +     // ISR time
-      AVR::Core::Ticks::Instruction::Jmp +  // Initial jmp table, could be eliminated with a custom .init table but as
-                                            // long as it's predictable, do we care?
-      Debug::EmitPulseAtISR +               // Pin toggle adds a clock cycle
-      AVR::Core::Ticks::Instruction::IJmp + // Our jmp to Z
-      0;
-
-  /**
-   * Number of ticks it takes the initial spin loop to check for the initial high-to-low transition.
-   *
-   * Most of the time, this number is used.
-   *
-   * Sometimes, the timer has overflowed and we need to check that our timeout counter hasn't reached zero.
-   * In this case, we chance being slightly more out of sync than normal. So we use the largest Timer period possible.
-   * In any case, it will resync on the next bit transition.
-   *
-   * @see `ticksInitialSpinLoopWorstCase`
-   *
-   * @note Maximum accuracy we can achieve of timing on initial transition
-   * @note These lists are generated from looking at the generated assembly for these functions.
-   */
-  constexpr unsigned ticksInitialSpinLoop =
-      AVR::Core::Ticks::Instruction::Skip1Word +  // Check Pin, skip over rjmp to normal
-      ResetWatchdog::WaitingFirstTransitionFast + // WDR
-      1 +                                         // Didn't overflow
-      AVR::Core::Ticks::Instruction::RJmp +       // Loop
-      0;
-
-  /**
-   * Number of ticks it takes the initial spin loop to check for the initial high-to-low transition while also
-   * decrementing and checking the timer overflow counter.
-   *
-   * This value is not used but computed for reference.
-   *
-   * @note Maximum accuracy we can achieve of timing on initial transition
-   * @note These lists are generated from looking at the generated assembly for these functions.
-   */
-  constexpr unsigned ticksInitialSpinLoopWorstCase =
-      AVR::Core::Ticks::Instruction::Skip1Word +           // Check Pin, skip over rjmp to normal
-      ResetWatchdog::WaitingFirstTransitionFast +          // WDR
-      AVR::Core::Ticks::Instruction::Skip1Word +           // Check Overflow Flag
-      1 +                                                  // subi; i--
-      1 +                                                  // breq; if (i == 0) {<exit path>} else ...
-      1 +                                                  // sbi; clear timer flag by setting it
-      ResetWatchdog::WaitingFirstTransitionTimerOverflow + // WDR
-      AVR::Core::Ticks::Instruction::RJmp +                // Back to main loop
-      0;
-
-  static_assert(ticksInitialSpinLoopWorstCase < ticksInitialSpinLoop * 3,
-                "ticksInitialSpinLoopWorstCase is curiously large");
-
-  /**
-   * Number of ticks from the initial high-to-low transition to when we can set the timer to some value.
-   *
-   * @note Part of the phase adjustment of reading bits on timer overflow
-   * @note These lists are generated from looking at the generated assembly for these functions.
-   */
-  constexpr unsigned ticksFromTransitionToInitialTimerSync =
-      AVR::Core::Ticks::Instruction::Skip1Word * useDebounce + // Debounce compensation
-      1 +                                                      // Check Pin  with `sbis`, it's low, don't skip
-      AVR::Core::Ticks::Instruction::RJmp +                    // Jump to Initial Ticks
-      ResetWatchdog::ReceivedFirstTransition +                 // WDR
-      AVR::Core::Ticks::Instruction::LoaDImediate +            // Set register to immediate
-      AVR::Core::Ticks::Instruction::Out +                     // Set timer counter from register
-      0;
-
-  /**
-   * Number of ticks it takes the ultra fast main spin loop to check for a transition
-   *
-   * @note Maximum accuracy we can achieve of timing on transition
-   */
-  constexpr unsigned ticksSpinLoop = Debug::EmitPulsesAtIdle +             // Pin toggle adds a clock cycle to the loop
-                                     1 +                                   // Reading the pin state takes 1 clock cycle
-                                     AVR::Core::Ticks::Instruction::RJmp + // Jump to start of loop
-                                     0;
+  constexpr unsigned responseTimeoutTicks = Periods::responseTimeoutTicks;
 
-  /**
-   * Number of ticks from a transition to when we can set the timer to some value.
-   * Receiving bits has a different code path that the initial transition.
-   *
-   * @note Part of the phase adjustment of reading bits on timer overflow
-   */
-  constexpr unsigned ticksFromTransitionToTimerSync =
-      AVR::Core::Ticks::Instruction::Skip1Word * useDebounce + // Debounce compensation
-      AVR::Core::Ticks::Instruction::Skip1Word +               // Read + skip rjmp for loop[]
-      AVR::Core::Ticks::Instruction::Out +                     // Set timer counter from register
-      0;
-
-  // Larger numbers will make the samples happen sooner
-  constexpr int fudgeInitialTicks = 0;
-  constexpr int fudgeSyncTicks = 0;
-
-  // constexpr unsigned adjustSyncTicks = ticksFromOverflowToISRSample + 1;
-  // constexpr unsigned adjustInitialTicks = adjustSyncTicks + 10;
-  constexpr unsigned adjustInitialTicks = ticksInitialSpinLoop / 2 +              // Half of the normal loop time
-                                          ticksFromTransitionToInitialTimerSync + // Initial sync
-                                          ticksFromOverflowToISRSample +          // Compensate for ISR service time
-                                          fudgeInitialTicks +                     // Let us easily fudge the numbers
-                                          0;
-
-  constexpr unsigned adjustSyncTicks = ticksSpinLoop / 2 +              // Half of the loop time
-                                       ticksFromTransitionToTimerSync + // Continuous sync
-                                       ticksFromOverflowToISRSample +   // Compensate for ISR service time
-                                       fudgeSyncTicks +                 // Let us easily fudge the numbers
-                                       0;
-
-  constexpr u1 timerCounterValueInitial = u1(adjustInitialTicks - Periods::delayHalfPeriodTicks);
-  constexpr u1 timerCounterValueSync = Periods::delayHalfPeriodTicks + adjustSyncTicks;
-
-  // Assumptions of these implementations
-  static_assert(Periods::delayPeriodTicks > adjustInitialTicks, "delayPeriodTicks is too small");
-  static_assert(Periods::delayPeriodTicks < 200, "delayPeriodTicks is too large");
+  // The cycle budget of everything below, solved into the values we load into the timer. See BDShotTiming.hpp
+  using Timing = ReceiveTiming<Periods::delayPeriodTicks, Periods::delayHalfPeriodTicks>;
 
   if (AssemblyComments) asm("; Starting timer with max timeout");
 
   constexpr unsigned counterUpperByte = responseTimeoutTicks >> 8;
-  u1 overflowsWhileWaiting = counterUpperByte + 1;
+
+  // Shorter than responseTimeoutTicks, if learned. The same constant otherwise.
+  u2 const timeoutTicks = Timeout::getTicks();
+  u1 overflowsWhileWaiting = (timeoutTicks >> 8) + 1;
 
   static_assert(counterUpperByte < u4(1) << (8 * sizeof(overflowsWhileWaiting)),
                 "counterUpperByte is too large for this implementation");
 
   BDShotTimer::setMaxTimeout();
-  BDShotTimer::setCounter(u1(-responseTimeoutTicks));
+  BDShotTimer::setCounter(u1(-timeoutTicks));
   BDShotTimer::clearOverflowMaxFlag();
   BDShotTimer::start();
 
   if (AssemblyComments) asm("; Waiting for first transition");
 
   // Wait for initial high-to-low transition, or timeout while waiting
-  while (isHigh() || (useDebounce && isHigh())) {
+  while (true) {
+    asm("; CycleBudget loop BDShot.initialSpin %0 %1"
+        :
+        : "n"(Timing::ticksInitialSpinLoop), "n"(Timing::ticksInitialSpinLoopWorstCase));
+    asm("; CycleBudget begin BDShot.initialSync %0" : : "n"(Timing::ticksFromTransitionToInitialTimerSync));
+
+    if (!(isHigh() || (useDebounce && isHigh()))) break;
+
     if (ResetWatchdog::WaitingFirstTransitionFast) asm("wdr");
 
     if (!BDShotTimer::hasOverflowMaxFlagged()) continue;
@@ -402,6 +338,8 @@ AVR::DShot::Response AVR::DShot::BDShot<Port, Pin, Speed>::getResponse() {
 
     if (!--overflowsWhileWaiting) {
       if (AssemblyComments) asm("; Return timeout");
+      asm("; CycleBudget stop BDShot.initialSpin");
+      asm("; CycleBudget stop BDShot.initialSync");
       // Timeout waiting for response
       return AVR::DShot::Response::Error::ResponseTimeout;
     }
@@ -412,13 +350,22 @@ AVR::DShot::Response AVR::DShot::BDShot<Port, Pin, Speed>::getResponse() {
     if (ResetWatchdog::WaitingFirstTransitionTimerOverflow) asm("wdr");
   }
 
+  asm("; CycleBudget stop BDShot.initialSpin");
+
   // Yay! We're getting a response. Try and receive it!
 
   if (ResetWatchdog::ReceivedFirstTransition) asm("wdr");
 
+  // Costs a cycle before the sync, which Timing knows about
+  u1 const turnaroundCounter = Turnaround::enabled ? BDShotTimer::getCounter() : 0;
+
   if (AssemblyComments) asm("; Initial Ticks");
   // Set timer so that it matches trigger register in 1.5 bit periods
-  BDShotTimer::setCounter(timerCounterValueInitial);
+  BDShotTimer::setCounter(Timing::timerCounterValueInitial);
+  asm("; CycleBudget end BDShot.initialSync");
+
+  // Turned into a time after we're done receiving
+  if (Turnaround::enabled) Turnaround::save(turnaroundCounter, overflowsWhileWaiting, BDShotTimer::getFlags());
   BDShotTimer::setShortTimeout();
   BDShotTimer::clearOverflowShortFlag();
 
@@ -467,11 +414,15 @@ AVR::DShot::Response AVR::DShot::BDShot<Port, Pin, Speed>::getResponse() {
     asm("" ::: ResultReg0, ResultReg1, ResultReg2, "r30", "r31"); // Remind the compiler
 
     do {
+      asm("; CycleBudget loop BDShot.waitHigh %0" : : "n"(Timing::ticksSpinLoop));
       if (Debug::EmitPulsesAtIdle) Debug::Pin::tgl();
       if (AssemblyComments) asm("; Ultra Fast Loop. Waiting for transition to high.");
+      asm("; CycleBudget begin BDShot.syncHigh %0" : : "n"(Timing::ticksFromTransitionToTimerSync));
     } while (!isHigh() || (useDebounce && !isHigh()));
 
-    BDShotTimer::setCounter(timerCounterValueSync);
+    asm("; CycleBudget stop BDShot.waitHigh");
+    BDShotTimer::setCounter(Timing::timerCounterValueSync);
+    asm("; CycleBudget end BDShot.syncHigh");
 
     if (ResetWatchdog::ReceivedTransition) asm("wdr");
 
@@ -481,11 +432,15 @@ AVR::DShot::Response AVR::DShot::BDShot<Port, Pin, Speed>::getResponse() {
     }
 
     do {
+      asm("; CycleBudget loop BDShot.waitLow %0" : : "n"(Timing::ticksSpinLoop));
       if (Debug::EmitPulsesAtIdle) Debug::Pin::tgl();
       if (AssemblyComments) asm("; Ultra Fast Loop. Waiting for transition to low.");
+      asm("; CycleBudget begin BDShot.syncLow %0" : : "n"(Timing::ticksFromTransitionToTimerSync));
     } while (isHigh() || (useDebounce && isHigh()));
 
-    BDShotTimer::setCounter(timerCounterValueSync);
+    asm("; CycleBudget stop BDShot.waitLow");
+    BDShotTimer::setCounter(Timing::timerCounterValueSync);
+    asm("; CycleBudget end BDShot.syncLow");
 
     if (ResetWatchdog::ReceivedTransition) asm("wdr");
 
@@ -502,13 +457,50 @@ AVR::DShot::Response AVR::DShot::BDShot<Port, Pin, Speed>::getResponse() {
 
 namespace MakeResponse {
 
-inline static constexpr bool isBadChecksum(Basic::u1 n3, Basic::u1 n2, Basic::u1 n1, Basic::u1 n0) {
-  return 0xf ^ n0 ^ n1 ^ n2 ^ n3;
-}
-
 static void interruptReturn() __attribute__((naked));
 void interruptReturn() { asm("reti"); }
 
+/**
+ * First we undo the shifting, then we turn 3 bytes into 4 quintets: n0 in r24, n1 to n3 in ResultReg0 to ResultReg2.
+ *
+ * Shared by every GCR::Decoder.
+ */
+#define UnshiftAndRegroup                                                                                              \
+  /* First we undo the shifting */                                                                                     \
+                                                                                                                       \
+  /* Use r24 instead of __temp_reg__ because we can */                                                                 \
+                                                                                                                       \
+  "mov  " /*        */ "r24, " ResultReg2 "\t; Copy byte 2\n\t"                                                        \
+  "lsr  " /*        */ "r24" /*        */ "\t; Shift the copy\n\t"                                                     \
+  "eor  " ResultReg2 ", r24" /*        */ "\t; XOR the copy back\n\t"                                                  \
+                                                                                                                       \
+  "mov  " /*        */ "r24, " ResultReg1 "\t; Copy byte 1\n\t"                                                        \
+  "ror  " /*        */ "r24" /*        */ "\t; Shift the copy\n\t"                                                     \
+  "eor  " ResultReg1 ", r24" /*        */ "\t; XOR the copy back\n\t"                                                  \
+                                                                                                                       \
+  "mov  " /*        */ "r24, " ResultReg0 "\t; Copy byte 0\n\t"                                                        \
+  "ror  " /*        */ "r24" /*        */ "\t; Shift the copy\n\t"                                                     \
+  "eor  " ResultReg0 ", r24" /*        */ "\t; XOR the copy back\n\t"                                                  \
+                                                                                                                       \
+  /* Now we turn 3 bytes into 4 quintets */                                                                            \
+                                                                                                                       \
+  /* Layout:                              Result 2 | Result 1 | Result 0|Carry */                                      \
+  "mov  r24, " /**/ ResultReg0 /**/ "\t; _--- 3333  3222 2211  1110 0000 ?\n\t" /* move n0 to r24 for later */         \
+                                                                                                                       \
+  "lsl  " /**/ ResultReg1 /**/ /**/ "\t; _--- 3333  2222 211_  1110 0000 3\n\t"                                        \
+  "rol  " ResultReg2 /**/ /**/ /**/ "\t; ---3 3333  2222 211_  1110 0000 _\n\t" /* n3 is ready in ResultReg2 */        \
+                                                                                                                       \
+  "lsr  " /**/ ResultReg1 /**/ /**/ "\t; ---3 3333  -222 2211  1110 0000 _\n\t"                                        \
+  "lsr  " /**/ ResultReg1 /**/ /**/ "\t; ---3 3333  --22 2221  1110 0000 1\n\t"                                        \
+  "ror  " /**/ /**/ ResultReg0 /**/ "\t; ---3 3333  --22 2221  1111 0000 0\n\t"                                        \
+  "lsr  " /**/ ResultReg1 /**/ /**/ "\t; ---3 3333  ---2 2222  1111 0000 1\n\t" /* n2 is ready in ResultReg1 */        \
+                                                                                                                       \
+  "andi " /**/ /**/ ResultReg0 ",0xf0\t; ---3 3333  ---2 2222  1111 ---- 1\n\t" /* Ensure lower nibble is 0 */         \
+  "adc  " /**/ /**/ ResultReg0 ",r1  \t; ---3 3333  ---2 2222  1111 ---1 _\n\t" /* Add Carry to lower nibble */        \
+  "swap " /**/ /**/ ResultReg0 /**/ "\t; ---3 3333  ---2 2222  ---1 1111 _\n\t" /* n1 is ready in ResultReg0 */        \
+                                                                                                                       \
+  "andi r24, 0x1f\n\t" /* r24 has some of n1 in it still. Mask it out. */
+
 static AVR::DShot::Response bitByBit() {
   using namespace AVR::DShot;
   using namespace BDShotConfig;
@@ -562,65 +554,52 @@ static AVR::DShot::Response bitByBit() {
 
   Basic::u1 n0, n1, n2, n3;
 
-  asm(
-      // First we undo the shifting
-
-      // Use r24 instead of __temp_reg__ because we can
-
-      "mov  " /*        */ "r24, " ResultReg2 "\t; Copy byte 2\n\t"
-      "lsr  " /*        */ "r24" /*        */ "\t; Shift the copy\n\t"
-      "eor  " ResultReg2 ", r24" /*        */ "\t; XOR the copy back\n\t"
-
-      "mov  " /*        */ "r24, " ResultReg1 "\t; Copy byte 1\n\t"
-      "ror  " /*        */ "r24" /*        */ "\t; Shift the copy\n\t"
-      "eor  " ResultReg1 ", r24" /*        */ "\t; XOR the copy back\n\t"
-
-      "mov  " /*        */ "r24, " ResultReg0 "\t; Copy byte 0\n\t"
-      "ror  " /*        */ "r24" /*        */ "\t; Shift the copy\n\t"
-      "eor  " ResultReg0 ", r24" /*        */ "\t; XOR the copy back\n\t"
-
-      // Now we turn 3 bytes into 4 quintets
-
-      // Layout:                              Result 2 | Result 1 | Result 0|Carry
-      "mov  r24, " /**/ ResultReg0 /**/ "\t; _--- 3333  3222 2211  1110 0000 ?\n\t" // move n0 to r24 for later
+  if (gcrDecoder == GCR::Decoder::Switch) {
+    asm(UnshiftAndRegroup
 
-      "lsl  " /**/ ResultReg1 /**/ /**/ "\t; _--- 3333  2222 211_  1110 0000 3\n\t"
-      "rol  " ResultReg2 /**/ /**/ /**/ "\t; ---3 3333  2222 211_  1110 0000 _\n\t" // n3 is ready in ResultReg2
+        // Decode the GCR encoded quintets into nibbles
+        // We don't need to worry about trash in the upper nibbles because decodeNibble() masks them out
 
-      "lsr  " /**/ ResultReg1 /**/ /**/ "\t; ---3 3333  -222 2211  1110 0000 _\n\t"
-      "lsr  " /**/ ResultReg1 /**/ /**/ "\t; ---3 3333  --22 2221  1110 0000 1\n\t"
-      "ror  " /**/ /**/ ResultReg0 /**/ "\t; ---3 3333  --22 2221  1111 0000 0\n\t"
-      "lsr  " /**/ ResultReg1 /**/ /**/ "\t; ---3 3333  ---2 2222  1111 0000 1\n\t" // n2 is ready in ResultReg1
+        "rcall %x[decodeNibble]\t; Decode nibbles\n\t"
+        "mov  %[n0], r24\n\t" // n0 was in r24 already
 
-      "andi " /**/ /**/ ResultReg0 ",0xf0\t; ---3 3333  ---2 2222  1111 ---- 1\n\t" // Ensure lower nibble is 0
-      "adc  " /**/ /**/ ResultReg0 ",r1  \t; ---3 3333  ---2 2222  1111 ---1 _\n\t" // Add Carry to lower nibble
-      "swap " /**/ /**/ ResultReg0 /**/ "\t; ---3 3333  ---2 2222  ---1 1111 _\n\t" // n1 is ready in ResultReg0
+        "mov  r24, " /**/ /**/ ResultReg0 "\n\t"
+        "rcall %x[decodeNibble]\t; Decode nibbles\n\t"
+        "mov  %[n1], r24\n\t" // n1 was in ResultReg0
 
-      // Decode the GCR encoded quintets into nibbles
-      // We don't need to worry about trash in the upper nibbles because decodeNibble() masks them out
+        "mov  r24, " /**/ ResultReg1 /**/ "\n\t"
+        "rcall %x[decodeNibble]\t; Decode nibbles\n\t"
+        "mov  %[n2], r24\n\t" // n2 was in ResultReg1
 
-      "andi r24, 0x1f\n\t" // r24 has some of n1 in it still. Mask it out.
+        "mov  r24, " ResultReg2 /**/ /**/ "\n\t"
+        "rcall %x[decodeNibble]\t; Decode nibbles\n\t"
+        "mov  %[n3], r24\n\t" // n3 was in ResultReg2
 
-      "rcall %x[decodeNibble]\t; Decode nibbles\n\t"
-      "mov  %[n0], r24\n\t" // n0 was in r24 already
+        // Let the compiler do the rest
 
-      "mov  r24, " /**/ /**/ ResultReg0 "\n\t"
-      "rcall %x[decodeNibble]\t; Decode nibbles\n\t"
-      "mov  %[n1], r24\n\t" // n1 was in ResultReg0
+        : [n0] "=r"(n0), [n1] "=r"(n1), [n2] "=r"(n2), [n3] "=r"(n3)
+        : [decodeNibble] "p"(&GCR::decode)
+        : "r24", ResultReg0, ResultReg1, ResultReg2);
+  } else {
+    asm(UnshiftAndRegroup
 
-      "mov  r24, " /**/ ResultReg1 /**/ "\n\t"
-      "rcall %x[decodeNibble]\t; Decode nibbles\n\t"
-      "mov  %[n2], r24\n\t" // n2 was in ResultReg1
+        // Let the compiler look the quintets up in the table inline. No calls.
 
-      "mov  r24, " ResultReg2 /**/ /**/ "\n\t"
-      "rcall %x[decodeNibble]\t; Decode nibbles\n\t"
-      "mov  %[n3], r24\n\t" // n3 was in ResultReg2
+        "mov  %[n0], r24\n\t"
+        "mov  %[n1], " ResultReg0 "\n\t"
+        "mov  %[n2], " ResultReg1 "\n\t"
+        "mov  %[n3], " ResultReg2 "\n\t"
 
-      // Let the compiler do the rest
+        : [n0] "=r"(n0), [n1] "=r"(n1), [n2] "=r"(n2), [n3] "=r"(n3)
+        :
+        : "r24", ResultReg0, ResultReg1, ResultReg2);
 
-      : [n0] "=r"(n0), [n1] "=r"(n1), [n2] "=r"(n2), [n3] "=r"(n3)
-      : [decodeNibble] "p"(&GCR::decode)
-      : "r24", ResultReg0, ResultReg1, ResultReg2);
+    // The quintets are clean, nothing above the lower 5 bits
+    n0 = GCR::decodeWith<gcrDecoder>(n0);
+    n1 = GCR::decodeWith<gcrDecoder>(n1);
+    n2 = GCR::decodeWith<gcrDecoder>(n2);
+    n3 = GCR::decodeWith<gcrDecoder>(n3);
+  }
 
   if (AssemblyComments) asm("; DONE WITH REGISTERS: " ResultReg0 " " ResultReg1 " " ResultReg2);
 
@@ -692,6 +671,7 @@ void AVR::DShot::BDShot<Port, Pin, Speed>::ReadBitISR() {
 }
 
 // Don't pollute
+#undef UnshiftAndRegroup
 #undef ResultReg0
 #undef ResultReg1
 #undef ResultReg2
@@ -722,5 +702,27 @@ AVR::DShot::Response AVR::DShot::BDShot<Port, Pin, Speed>::sendCommand(Command<t
   // Return pin to input mode
   Parent::input();
 
-  return getResponse();
+  // What getResponse() is about to use
+  u2 const timeoutTicks = Timeout::getTicks();
+
+  auto const res = getResponse();
+
+  if (Turnaround::enabled) {
+    auto const &t = Turnaround::get();
+
+    u1 const counterStart = u1(-timeoutTicks);
+    u1 const overflowsStart = (timeoutTicks >> 8) + 1;
+
+    u1 overflows = overflowsStart - t.overflowsLeft;
+
+    // The counter wrapped just before the start bit, before the spin loop could see it
+    if (t.flags & (1 << TOV0) && t.counter < 0x80) overflows++;
+
+    u2 const turnaroundTicks = (u2(overflows) << 8) + t.counter - counterStart;
+
+    Stats::record(res, turnaroundTicks);
+    Timeout::record(res, turnaroundTicks);
+  }
+
+  return res;
 }
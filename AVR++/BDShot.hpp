@@ -9,6 +9,9 @@
  * It supports as any motors as you wish but can only access them in a round-robin fashion and interrupts must be
  * disabled. This implementation requires _full control_ of interrupts.
  *
+ * @see BDShotGroup.hpp to talk to several motors on the same Port at the same time.
+ * @see BDShotCapture.hpp to keep other interrupts enabled while receiving.
+ *
  * The DShot and BDShot protocols are described well here: https://brushlesswhoop.com/dshot-and-bidirectional-dshot
  *
  * For performance reasons, most of the configuration is locked at compile time with template parameters.
@@ -16,6 +19,9 @@
  * While this implementation is a "classes", it is not intended to be instantiated.
  * `using` is the preferred method of access.
  *
+ * Response bits need to be ~30 CPU cycles or longer for the receive loop to keep up: DSHOT150 at 8 MHz and up, DSHOT300
+ * at 12 MHz and up. Unsupported combinations fail to compile. The sample point is picked automatically.
+ *
  * Watch out for the ESC detecting a long "high" state (BDShot idles high) as a command to enter the bootloader.
  *
  * Simplified API:
@@ -24,6 +30,11 @@
  * class AVR::DShot::BDShot {
  *   static void init();
  *   static Response sendCommand(Command);
+ *   static void exitBootloader();                 // Blocks for BDShotConfig::exitBootloaderDelay
+ *   static void startExitBootloader(u2 nowMs);    // Or, don't block
+ *   static bool pollExitBootloader(u2 nowMs);     // true once the line is released
+ *   static LinkSnapshot getLinkQuality(); // With BDShotConfig::LinkStats::enabled. See BDShotLinkQuality.hpp
+ *   static void resetLinkQuality();
  * }
  *
  * Simplest Usage BDShot:
@@ -82,12 +93,23 @@
  *     // Get useful numbers
  *     u2 period = res.getPeriodMicros();
  *     float rpm = res.getRPM();
+ *     u3 erpm = res.getERPM(); // Much faster
  *
  *     // Do something with the motor telemetry
  *   }
  * }
  * ```
  *
+ * Leaving the bootloader of several ESCs at once, without blocking:
+ *
+ * ```C++
+ * ESC1::startExitBootloader(millis);
+ * ESC2::startExitBootloader(millis);
+ *
+ * // Do other things, like resetting the watchdog. Poll every ESC until all are released.
+ * while (!(ESC1::pollExitBootloader(millis) & ESC2::pollExitBootloader(millis))) wdt_reset();
+ * ```
+ *
  * @see An explanation of using template classes in cpp files:
  * https://stackoverflow.com/questions/115703/storing-c-template-function-definitions-in-a-cpp-file/41292751#41292751
  *
@@ -105,12 +127,21 @@
  *   inline constexpr u1        getTelemetryValue()   const;
  *   inline constexpr u2        getPeriodMicros()     const;
  *   inline constexpr float     getRPM()              const;
+ *   inline           u3        getERPM()             const; // No float math. See Reciprocal.hpp
+ *   template <u1 PolePairs>
+ *   inline           u3        getMechanicalRPM()    const;
+ *   template <u1 PolePairs = 1>
+ *   inline           u3        getHz()               const;
  *   inline constexpr bool      isStopped()           const;
  *   inline constexpr operator  u2()                  const { return getPeriodMicros(); }
  * }
  *
  */
 
+#include "BDShotConfig.hpp"
+#include "BDShotLinkQuality.hpp"
+#include "BDShotResponse.hpp"
+#include "BDShotTurnaround.hpp"
 #include "DShot.hpp"
 
 // cSpell:ignore GPIO USART RXCIE TXCIE UDRIE
@@ -120,151 +151,59 @@ namespace DShot {
 using namespace AVR;
 using namespace Basic;
 
+// The parts of the configuration that need the hardware
 namespace BDShotConfig {
-constexpr double exitBootloaderDelay = 400 /* or 1300 */; // ms
-constexpr unsigned responseTimeout = 50;                  // us
-
-/**
- * @brief Should we support the new Extended DShot Telemetry protocol?
- * @see https://brushlesswhoop.com/dshot-and-bidirectional-dshot/#extended-dshot-telemetry-edt
- */
-constexpr bool supportEDT = true;
-
-constexpr bool useDebounce = false;
-
-namespace AssemblyOptimizations {
-// Not needed.
-// Saves a word of flash and a clock cycle, but this is at the end when speed doesn't matter as much.
-// Relative jumps are faster but can't reach whole program space.
-// If you see errors about "relocation truncated to fit", try setting this to "false".
-constexpr bool useRelativeJmpAtEndISR = true;
-
-// Shouldn't be needed since we use call-clobbered registers.
-constexpr bool saveResultRegisters = false;
-constexpr bool saveZRegister = false;
-} // namespace AssemblyOptimizations
-
-// All of these are way overkill. The minimum watchdog timeout is 15ms and the maximum time here is 250us.
-namespace ResetWatchdog {
-constexpr bool AfterSend = false;                           // After ~107us, for DSHOT150
-constexpr bool WaitingFirstTransitionFast = false;          // Ever <1us while waiting for first transition
-constexpr bool WaitingFirstTransitionTimerOverflow = false; // Every 2.7us
-constexpr bool ReceivedFirstTransition = false;             // Maximum responseTimeout after sending command
-constexpr bool ReceivedTransition = false;                  // Every time we receive a transition, min period 2.7us
-constexpr bool SampledBit = false;                          // Every time we sample a bit, every 2.7us for DSHOT150
-constexpr bool BeforeProcessing = false;                    // After sampling 20 bits
-} // namespace ResetWatchdog
-
-// Debugging/development features
 namespace Debug {
 // Use PB6 as an extra GPIO to verify timing for various parts of the code
 using Pin = AVR::Output<AVR::Ports::B, 8>;
-
-constexpr bool EmitPulseAtISR = false;
-constexpr bool EmitPulsesAtIdle = false;
-constexpr bool EmitPulseAtSync = false;
 } // namespace Debug
 } // namespace BDShotConfig
 
-class Response {
-public:
-  constexpr static unsigned BaseBits = 9;
-  constexpr static unsigned ExponentBits = 3;
-  constexpr static u1 ExponentMax = 1 << ExponentBits;
-  constexpr static u1 ExponentTop = ExponentMax - 1;
-  constexpr static u1 ExponentMask = ExponentMax - 1;
-
-private:
-  u1 lsb;
-  u1 msb;
-
-  constexpr static u1 ErrorMask = 1 << 7;
-
-public:
-  enum class Error : u1 {
-    None,
-    ResponseTimeout,
-    BadDecodeFirstNibble,
-    BadDecodeSecondNibble,
-    BadDecodeThirdNibble,
-    BadDecodeFourthNibble,
-    BadChecksum,
-  };
-
-  /**
-   * Error by default
-   */
-  inline constexpr Response(Error e) : lsb(static_cast<u1>(e)), msb(ErrorMask) {}
-  /**
-   * @param rpmPeriodBase
-   * @param rpmPeriodExponent
-   */
-  inline constexpr Response(u1 lsb, u1 msb) : lsb(lsb), msb(msb) {}
-
-  /**
-   * @return true if there was an error
-   */
-  inline bool constexpr isError() const { return msb & ErrorMask; }
-
-  inline constexpr operator bool() const { return !isError(); }
-
-  inline Error constexpr getError() const {
-    if (!isError()) return Error::None;
-    return static_cast<Error>(lsb);
+/**
+ * @brief The length of a single bit of the ESC's response
+ *
+ * The response is sent 5/4 faster than the command so that 20 GCR bits take the same time as 16 command bits.
+ */
+constexpr double responseBitNanos(Speeds speed) {
+  switch (speed) {
+  case Speeds::DSHOT150:
+    return 4e9 / 150e3 / 5;
+  case Speeds::DSHOT300:
+    return 4e9 / 300e3 / 5;
+  case Speeds::DSHOT600:
+    return 4e9 / 600e3 / 5;
+  case Speeds::DSHOT1200:
+    return 4e9 / 1200e3 / 5;
   }
+  return 0;
+}
 
-  /**
-   * @brief Check if this packet is a telemetry packet.
-   *
-   * Do not use if this is an error Response.
-   *
-   * @return true
-   * @return false
-   */
-  inline bool constexpr isExtendedTelemetry() const { return BDShotConfig::supportEDT && !(msb & 1); }
-
-  enum class Telemetry : u1 {
-    None = 0x00,
-    Temperature = 0x02,
-    Voltage = 0x04,
-    Current = 0x06,
-    Debug1 = 0x08,
-    Debug2 = 0x0A,
-    Debug3 = 0x0C,
-    State_Event = 0x0E,
-  };
-  inline Telemetry constexpr getTelemetryType() const { return static_cast<Telemetry>(msb); }
-
-  inline u1 constexpr getTelemetryValue() const { return BDShotConfig::supportEDT ? lsb : -1; }
+/**
+ * @brief When a line held low to exit an ESC's bootloader may be released
+ *
+ * Times come from any free running millisecond counter the application already has, like a timer interrupt or the USB
+ * frame number. Wrapping is fine as long as it's polled at least every 32 seconds.
+ */
+class BootloaderDeadline {
+  u2 deadline;
+  bool waiting = false;
 
-  inline constexpr u2 getBase() const { return (u2(BDShotConfig::supportEDT | (msb & 1)) << 8) | lsb; }
-  inline constexpr u2 getExponent() const {
-    // Don't need to mask because it's not an error
-    return msb >> 1;
+public:
+  inline void start(u2 nowMs) {
+    deadline = nowMs + u2(BDShotConfig::exitBootloaderDelay + 0.5);
+    waiting = true;
   }
 
-  inline u2 constexpr getPeriodMicros() const { return getBase() << getExponent(); }
-
-  inline constexpr operator u2() const { return getPeriodMicros(); }
+  inline bool isWaiting() const { return waiting; }
 
   /**
-   * @brief Convert internal notation to float rpm
-   * @warning Check there is no error before calling this function
-   *
-   * @details
-   *                 1 Electrical Revolution           1e6 us   60 seconds
-   * speed = --------------------------------------- * ------ * ----------
-   *         (rpmPeriodBase << rpmPeriodExponent) us   second     minute
-   *
-   *                       60 * 1e6               Electrical Revolutions
-   *       = ------------------------------------ ---------per----------
-   *         (rpmPeriodBase << rpmPeriodExponent)         minute
-   *
-   * @return float eRPM of motor
+   * @return true only the first time it's polled after the deadline
    */
-  inline float constexpr getRPM(u1 polePairs = 1) const { return 60e6 / (u3(polePairs) * getPeriodMicros()); }
-
-  inline bool constexpr isStopped() const { return msb == 0x0f && lsb == 0xff; }
+  inline bool poll(u2 nowMs) {
+    if (!waiting || s2(nowMs - deadline) < 0) return false;
+    waiting = false;
+    return true;
+  }
 };
 
 template <Ports Port, int Pin, Speeds Speed = NominalSpeed>
@@ -273,26 +212,20 @@ class BDShot : protected DShot<Port, Pin, Speed, true> {
 
 protected:
   struct Periods {
-    inline static constexpr double samplePeriodNanos(Speeds speed) {
-      switch (speed) {
-      case Speeds::DSHOT150:
-        return 4e9 / 150e3 / 5;
-      case Speeds::DSHOT300:
-        return 4e9 / 300e3 / 5;
-      case Speeds::DSHOT600:
-        return 4e9 / 600e3 / 5;
-      case Speeds::DSHOT1200:
-        return 4e9 / 1200e3 / 5;
-      }
-      return 0;
-    }
-
-    static constexpr double bitPeriodNanos = samplePeriodNanos(Speed);
+    static constexpr double bitPeriodNanos = responseBitNanos(Speed);
     static constexpr unsigned delayPeriodTicks = Const::round(bitPeriodNanos * F_CPU / 1e9);
     static constexpr unsigned delayHalfPeriodTicks = Const::round(bitPeriodNanos * F_CPU / 1e9 / 2);
     static constexpr unsigned delay3HalfPeriodTicks = Const::round(bitPeriodNanos * 3 * F_CPU / 1e9 / 2);
+    static constexpr unsigned responseTimeoutTicks = (((long long)(F_CPU)) * BDShotConfig::responseTimeout) / 1e6;
+    static constexpr unsigned timeoutMarginTicks = F_CPU * (BDShotConfig::AdaptiveTimeout::marginMicros / 1e6);
   };
 
+  using Stats = LinkQuality<BDShot, Periods::responseTimeoutTicks>;
+  using Timeout = AdaptiveTimeout<BDShot, Periods::responseTimeoutTicks, Periods::timeoutMarginTicks>;
+  using Turnaround = TurnaroundStash<BDShot>;
+
+  static BootloaderDeadline bootloader;
+
   using Parent = DShot<Port, Pin, Speed, true>;
   using Parent::isHigh;
 
@@ -320,7 +253,34 @@ public:
   static Response sendCommand(Command<true> c);
 
   static void init();
+
+  /**
+   * @brief Hold the line low long enough for the ESC to leave its bootloader. Blocks the whole time.
+   */
   static void exitBootloader();
+
+  /**
+   * @brief Like `exitBootloader()` but returns right away. Many ESCs can wait at the same time.
+   *
+   * Don't send commands until `pollExitBootloader()` returns true.
+   *
+   * @param nowMs Any free running millisecond count
+   */
+  static void startExitBootloader(u2 nowMs);
+
+  /**
+   * @brief Release the line once it's been low long enough
+   *
+   * @param nowMs Same millisecond count as `startExitBootloader()`
+   * @return true once the line has been released and commands can be sent
+   */
+  static bool pollExitBootloader(u2 nowMs);
+
+  /**
+   * @return Counters of every Response so far. All zeros unless `BDShotConfig::LinkStats::enabled`.
+   */
+  inline static LinkSnapshot getLinkQuality() { return Stats::snapshot(); }
+  inline static void resetLinkQuality() { Stats::reset(); }
 };
 
 } // namespace DShot
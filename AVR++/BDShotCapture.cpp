@@ -0,0 +1,137 @@
+#pragma once
+
+/**
+ * @file BDShotCapture.cpp
+ * @author Cameron Tacklind <cameron@tacklind.com>
+ * @brief The implementation of the BDShotCapture class
+ * @note This file is part of the AVR++ library.
+ */
+
+#include "BDShotCapture.hpp"
+#include "IOpin.hpp"
+#include "Nop.hpp"
+
+// Yes, we're including the cpp. We share the Response decoding.
+#include "BDShot.cpp"
+
+// cSpell:ignore ICNC ICES ICIE OCIE
+
+using AVR::DShot::InputCapture;
+
+Basic::u2 InputCapture::edges[InputCapture::MaxEdges];
+volatile Basic::u1 InputCapture::count;
+volatile bool InputCapture::done = true;
+volatile bool InputCapture::missed;
+Basic::u2 InputCapture::quietTicks;
+
+void InputCapture::init() {
+  TIMSK1 = 0;
+
+  // Normal mode
+  TCCR1A = 0;
+
+  // No prescaler. Noise canceler delays every edge by the same 4 cycles so it doesn't hurt the edge deltas.
+  TCCR1B = 1 << ICNC1 | 0 << ICES1 | 1 << CS10;
+}
+
+void InputCapture::arm(Basic::u2 const windowTicks, Basic::u2 const quietTicks) {
+  // Make sure our interrupts don't touch anything while we set up
+  TIMSK1 = 0;
+
+  count = 0;
+  done = false;
+  missed = false;
+  InputCapture::quietTicks = quietTicks;
+
+  // Look for the falling start edge first
+  TCCR1B &= ~(1 << ICES1);
+
+  TIFR1 = 1 << ICF1 | 1 << OCF1A;
+
+  OCR1A = TCNT1 + windowTicks;
+
+  TIMSK1 = 1 << ICIE1 | 1 << OCIE1A;
+}
+
+inline void InputCapture::capture() {
+  Basic::u2 const t = ICR1;
+
+  // Look for the other edge next. The flag needs to be cleared after changing edges.
+  TCCR1B ^= 1 << ICES1;
+  TIFR1 = 1 << ICF1;
+
+  Basic::u1 n = count;
+  edges[n++] = t;
+  count = n;
+
+  // Wait a little longer for the next edge
+  OCR1A = t + quietTicks;
+
+  bool const lookingForRising = TCCR1B & (1 << ICES1);
+
+  // If the line is already where the next edge would take it, that edge came after the flag was cleared, or before.
+  bool const moved = IOpin<AVR::DShot::InputCapturePort, AVR::DShot::InputCapturePin>::isHigh() == lookingForRising;
+
+  // The noise canceler flags an edge 4 cycles after the pin shows it. Give it that long before checking for it.
+  AVR::nopCycles(4);
+
+  // If it came after, it was captured and we'll get it next. Only if it wasn't did we miss one.
+  if (moved && !(TIFR1 & (1 << ICF1))) {
+    // The runs after it would be wrong. Stop capturing and report it.
+    missed = true;
+    TIMSK1 &= ~(1 << ICIE1);
+    return;
+  }
+
+  if (n == MaxEdges) TIMSK1 &= ~(1 << ICIE1);
+}
+
+inline void InputCapture::timeout() {
+  TIMSK1 = 0;
+  done = true;
+}
+
+ISR(TIMER1_CAPT_vect) { InputCapture::capture(); }
+ISR(TIMER1_COMPA_vect) { InputCapture::timeout(); }
+
+template <AVR::DShot::Speeds Speed>
+void AVR::DShot::BDShotCapture<Speed>::init() {
+  InputCapture::init();
+
+  if (AssemblyComments) asm("; Init BDShotCapture");
+
+  // Set output high
+  Parent::IO::set();
+}
+
+template <AVR::DShot::Speeds Speed>
+void AVR::DShot::BDShotCapture<Speed>::startCommand(Command<true> c) {
+  // Set output mode only while sending command
+  Parent::output();
+
+  Parent::sendCommand(c);
+
+  // Return pin to input mode
+  Parent::input();
+
+  arm(Periods::windowTicks, Periods::quietTicks);
+}
+
+template <AVR::DShot::Speeds Speed>
+AVR::DShot::Response AVR::DShot::BDShotCapture<Speed>::getResponse() {
+  while (!isDone())
+    ;
+
+  Basic::u1 const n = count;
+
+  if (!n) return Response::Error::ResponseTimeout;
+
+  if (missed) return Response::Error::MissedEdge;
+
+  MakeResponse::FromRuns frame;
+
+  for (Basic::u1 i = 1; i < n; i++)
+    if (frame.add(bitsInRun(edges[i] - edges[i - 1]))) break;
+
+  return frame.finish();
+}
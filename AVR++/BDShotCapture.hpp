@@ -0,0 +1,184 @@
+#pragma once
+
+/**
+ * @brief BDShot implementation for AVRs that receives with Timer1 Input Capture
+ * @file BDShotCapture.hpp
+ * @author Cameron Tacklind <cameron@tacklind.com>
+ *
+ * `BDShot` recovers the ESC's clock in a spin loop, so every other interrupt must be disabled while it listens.
+ * This implementation lets the hardware timestamp each edge of the response instead. Each edge only costs a short
+ * interrupt and the 21 bit frame is rebuilt from the time between edges after the response is over.
+ *
+ * Other interrupts can stay enabled while receiving. After each edge, our interrupt has to switch which edge it's
+ * looking for before the next one, one response bit later at the soonest. Getting into our interrupt and saving its
+ * registers comes out of that bit too, so any other interrupt has to fit in what's left. That's roughly 30 of the ~43
+ * cycles of a DSHOT300 bit at 16MHz, so little more than the shortest ISR fits. DSHOT150 leaves about 50 cycles. If
+ * an edge is missed anyway, capturing stops and `getResponse()` returns `Response::Error::MissedEdge` instead of
+ * misreading the frame.
+ *
+ * Sending the command is still bit-banged with interrupts disabled.
+ *
+ * Requires the ICP1 pin and takes over Timer1.
+ *
+ * Simplified API:
+ *
+ * template <AVR::DShot::Speeds Speed = [150/300]>
+ * class AVR::DShot::BDShotCapture {
+ *   static void init();
+ *   static Response sendCommand(Command<true>);
+ *
+ *   // Or, to do other things while waiting for the response
+ *   static void startCommand(Command<true>);
+ *   static bool isDone();
+ *   static Response getResponse();
+ * }
+ *
+ * Usage:
+ *
+ * ```main.cpp
+ * #include <AVR++/BDShotCapture.cpp> // Yes, a cpp file
+ *
+ * using ESC = AVR::DShot::BDShotCapture<>;
+ *
+ * template class AVR::DShot::BDShotCapture<>;
+ *
+ * int main() {
+ *   ESC::init();
+ *   sei();
+ *
+ *   while (true) {
+ *     ESC::startCommand(0.5);
+ *
+ *     // Do other things, with interrupts on
+ *
+ *     auto res = ESC::getResponse();
+ *   }
+ * }
+ * ```
+ *
+ * @see BDShot.hpp for `Response`
+ */
+
+#include "BDShot.hpp"
+#include <avr/interrupt.h>
+
+// cSpell:ignore CAPT COMPA
+
+ISR(TIMER1_CAPT_vect);
+ISR(TIMER1_COMPA_vect);
+
+namespace AVR {
+namespace DShot {
+using namespace AVR;
+using namespace Basic;
+
+#ifdef __AVR_ATmega32U4__
+constexpr Ports InputCapturePort = Ports::D;
+constexpr int InputCapturePin = 4;
+#endif
+// TODO: Support more chips here
+
+/**
+ * @brief The part of the receiver that is shared with the interrupts. There is only one ICP1.
+ */
+class InputCapture {
+  friend void ::TIMER1_CAPT_vect();
+  friend void ::TIMER1_COMPA_vect();
+
+protected:
+  /**
+   * The start edge, at most one edge per bit after that, and the edge back to idle.
+   */
+  static constexpr u1 MaxEdges = 22;
+
+  static u2 edges[MaxEdges];
+  static volatile u1 count;
+  static volatile bool done;
+  // An edge came while we were looking for the other one
+  static volatile bool missed;
+
+  /**
+   * Timer ticks without an edge before we decide the response is over
+   */
+  static u2 quietTicks;
+
+  static void capture();
+  static void timeout();
+
+  static void init();
+
+  /**
+   * @brief Start looking for the falling edge of a response
+   *
+   * @param windowTicks Timer ticks to wait for the whole response
+   * @param quietTicks Timer ticks without an edge that mean the response is over
+   */
+  static void arm(u2 windowTicks, u2 quietTicks);
+
+public:
+  /**
+   * @return true once the response is over, or timed out
+   */
+  inline static bool isDone() { return done; }
+};
+
+template <Speeds Speed = NominalSpeed>
+class BDShotCapture : protected DShot<InputCapturePort, InputCapturePin, Speed, true>, public InputCapture {
+  using Parent = DShot<InputCapturePort, InputCapturePin, Speed, true>;
+
+protected:
+  struct Periods {
+    static constexpr double bitTicks = responseBitNanos(Speed) * F_CPU / 1e9;
+
+    // Rounding thresholds for the number of bits between edges
+    static constexpr u2 ticks1_5 = Const::round(bitTicks * 1.5);
+    static constexpr u2 ticks2_5 = Const::round(bitTicks * 2.5);
+    static constexpr u2 ticks3_5 = Const::round(bitTicks * 3.5);
+
+    // GCR never has more than 3 bits without a transition
+    static constexpr u2 quietTicks = Const::round(bitTicks * 4);
+
+    static constexpr double windowTicksExact = BDShotConfig::responseTimeout * (F_CPU / 1e6) + (21 + 1) * bitTicks;
+
+    static_assert(windowTicksExact < 0x10000, "Response window is too long for Timer1 at this F_CPU");
+
+    static constexpr u2 windowTicks = Const::round(windowTicksExact);
+  };
+
+  /**
+   * @brief The number of bits the line stayed at a level
+   *
+   * Branch free rounding. More than 3 bits can't happen and will fail to decode.
+   */
+  inline static u1 bitsInRun(u2 ticks) {
+    return 1 + (ticks >= Periods::ticks1_5) + (ticks >= Periods::ticks2_5) + (ticks >= Periods::ticks3_5);
+  }
+
+public:
+  // Exposed for development/debugging
+  using Parent::PulseMath;
+
+  static void init();
+
+  /**
+   * @brief Send the command and start listening for the response. Returns as soon as the command is sent.
+   *
+   * Interrupts are disabled while sending and enabled when done.
+   */
+  static void startCommand(Command<true> c);
+
+  /**
+   * @brief Wait for the response, if needed, and decode it
+   *
+   * Global interrupts must be enabled.
+   */
+  static Response getResponse();
+
+  inline static Response sendCommand(Command<true> c) {
+    startCommand(c);
+    return getResponse();
+  }
+};
+
+} // namespace DShot
+} // namespace AVR
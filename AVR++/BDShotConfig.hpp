@@ -0,0 +1,119 @@
+#pragma once
+
+/**
+ * @brief Compile time configuration of the BDShot implementations
+ * @file BDShotConfig.hpp
+ * @author Cameron Tacklind <cameron@tacklind.com>
+ *
+ * Free of hardware dependencies so host side tools, like BDShotSim.hpp, see the same configuration as the chip.
+ * `Debug::Pin` is added in BDShot.hpp.
+ */
+
+#include "GCR.hpp"
+
+namespace AVR {
+namespace DShot {
+
+namespace BDShotConfig {
+constexpr double exitBootloaderDelay = 400 /* or 1300 */; // ms
+constexpr unsigned responseTimeout = 50;                  // us
+
+/**
+ * @brief Should we support the new Extended DShot Telemetry protocol?
+ * @see https://brushlesswhoop.com/dshot-and-bidirectional-dshot/#extended-dshot-telemetry-edt
+ */
+constexpr bool supportEDT = true;
+
+constexpr bool useDebounce = false;
+
+/**
+ * @brief Count every Response by Error and keep a histogram of how long ESCs take to start responding
+ *
+ * Costs a cycle in the receiver's initial sync, which is accounted for, and a few more before it starts watching for
+ * transitions. Nothing at all when disabled.
+ *
+ * @see BDShotLinkQuality.hpp
+ */
+namespace LinkStats {
+constexpr bool enabled = false;
+
+// Buckets in the turnaround histogram. They're sized to cover `responseTimeout`.
+constexpr unsigned latencyBins = 16;
+
+// The success ratio is a moving average over about 2^successRatioShift frames
+constexpr unsigned successRatioShift = 5;
+} // namespace LinkStats
+
+/**
+ * @brief Wait for each ESC's start bit only as long as that ESC actually needs, instead of `responseTimeout`
+ *
+ * Learned from the turnaround of recent responses. Shortens the time lost to an ESC that is missing or rebooting.
+ *
+ * @see BDShotTurnaround.hpp
+ */
+namespace AdaptiveTimeout {
+constexpr bool enabled = false;
+
+// Added to the slowest recent turnaround, on top of 1/8 of it
+constexpr unsigned marginMicros = 4; // us
+
+// Consecutive timeouts before going back to waiting the whole `responseTimeout`
+constexpr unsigned fallbackMisses = 2;
+} // namespace AdaptiveTimeout
+
+/**
+ * The receiver reads the timer at the start bit when anything needs to know the turnaround
+ */
+constexpr bool captureTurnaround = LinkStats::enabled || AdaptiveTimeout::enabled;
+
+/**
+ * @brief Nudge the receive timing, in CPU cycles. Larger numbers make the samples happen sooner.
+ * @see BDShotSim.hpp to pick these from data
+ */
+constexpr int fudgeInitialTicks = 0;
+constexpr int fudgeSyncTicks = 0;
+
+/**
+ * @brief How to decode the GCR quintets once the response has been received
+ *
+ * Everything after the last bit is received is added latency.
+ * The table decoders are faster but use more memory.
+ *
+ * @see GCR::Decoder
+ * @see GCRBenchmark.hpp to measure the options on your build
+ */
+constexpr GCR::Decoder gcrDecoder = GCR::Decoder::Switch;
+
+namespace AssemblyOptimizations {
+// Not needed.
+// Saves a word of flash and a clock cycle, but this is at the end when speed doesn't matter as much.
+// Relative jumps are faster but can't reach whole program space.
+// If you see errors about "relocation truncated to fit", try setting this to "false".
+constexpr bool useRelativeJmpAtEndISR = true;
+
+// Shouldn't be needed since we use call-clobbered registers.
+constexpr bool saveResultRegisters = false;
+constexpr bool saveZRegister = false;
+} // namespace AssemblyOptimizations
+
+// All of these are way overkill. The minimum watchdog timeout is 15ms and the maximum time here is 250us.
+namespace ResetWatchdog {
+constexpr bool AfterSend = false;                           // After ~107us, for DSHOT150
+constexpr bool WaitingFirstTransitionFast = false;          // Ever <1us while waiting for first transition
+constexpr bool WaitingFirstTransitionTimerOverflow = false; // Every 2.7us
+constexpr bool ReceivedFirstTransition = false;             // Maximum responseTimeout after sending command
+constexpr bool ReceivedTransition = false;                  // Every time we receive a transition, min period 2.7us
+constexpr bool SampledBit = false;                          // Every time we sample a bit, every 2.7us for DSHOT150
+constexpr bool BeforeProcessing = false;                    // After sampling 20 bits
+} // namespace ResetWatchdog
+
+// Debugging/development features
+namespace Debug {
+constexpr bool EmitPulseAtISR = false;
+constexpr bool EmitPulsesAtIdle = false;
+constexpr bool EmitPulseAtSync = false;
+} // namespace Debug
+} // namespace BDShotConfig
+
+} // namespace DShot
+} // namespace AVR
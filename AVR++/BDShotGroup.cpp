@@ -0,0 +1,206 @@
+#pragma once
+
+/**
+ * @file BDShotGroup.cpp
+ * @author Cameron Tacklind <cameron@tacklind.com>
+ * @brief The implementation of the BDShotGroup class
+ * @note This file is part of the AVR++ library.
+ *
+ * @see The comments in BDShotGroup.hpp for more information on the internal workings of this implementation.
+ */
+
+#include "BDShotGroup.hpp"
+#include "Nop.hpp"
+#include <util/delay.h>
+
+// Yes, we're including the cpp. We share the timer helpers and Response decoding.
+#include "BDShot.cpp"
+
+template <AVR::Ports Port, Basic::u1 PinMask, AVR::DShot::Speeds Speed>
+void AVR::DShot::BDShotGroup<Port, PinMask, Speed>::init() {
+  BDShotTimer::init(SampleMath::ticks);
+
+  if (AssemblyComments) asm("; Init BDShotGroup");
+
+  // Set outputs high
+  port() |= PinMask;
+}
+
+template <AVR::Ports Port, Basic::u1 PinMask, AVR::DShot::Speeds Speed>
+void AVR::DShot::BDShotGroup<Port, PinMask, Speed>::exitBootloader() {
+  if (AssemblyComments) asm("; Waiting for bootloader exit");
+
+  // Outputs need to be low long enough to get out of bootloader and start main program
+  port() &= ~PinMask;
+  ddr() |= PinMask;
+
+  _delay_ms(BDShotConfig::exitBootloaderDelay);
+
+  if (AssemblyComments) asm("; Done waiting for bootloader exit");
+
+  // Set outputs high
+  port() |= PinMask;
+}
+
+template <AVR::Ports Port, Basic::u1 PinMask, AVR::DShot::Speeds Speed>
+AVR::DShot::BootloaderDeadline AVR::DShot::BDShotGroup<Port, PinMask, Speed>::bootloader;
+
+template <AVR::Ports Port, Basic::u1 PinMask, AVR::DShot::Speeds Speed>
+void AVR::DShot::BDShotGroup<Port, PinMask, Speed>::startExitBootloader(u2 nowMs) {
+  if (AssemblyComments) asm("; Start waiting for bootloader exit");
+
+  // Outputs need to be low long enough to get out of bootloader and start main program
+  port() &= ~PinMask;
+  ddr() |= PinMask;
+
+  bootloader.start(nowMs);
+}
+
+template <AVR::Ports Port, Basic::u1 PinMask, AVR::DShot::Speeds Speed>
+bool AVR::DShot::BDShotGroup<Port, PinMask, Speed>::pollExitBootloader(u2 nowMs) {
+  if (bootloader.isWaiting()) {
+    if (!bootloader.poll(nowMs)) return false;
+
+    if (AssemblyComments) asm("; Done waiting for bootloader exit");
+
+    // Set outputs high
+    port() |= PinMask;
+  }
+
+  return true;
+}
+
+template <AVR::Ports Port, Basic::u1 PinMask, AVR::DShot::Speeds Speed>
+void AVR::DShot::BDShotGroup<Port, PinMask, Speed>::send(u1 const *ones, u1 const on, u1 const off) {
+  asm volatile("; BDShotGroup::send()");
+
+  u1 n = FrameBits;
+  do {
+    u1 b = *ones++ ^ off;
+
+    // Make sure the compiler doesn't move the load into our pulse
+    asm volatile("; Port value for this bit in %0" : "+r"(b));
+
+    asm("; CycleBudget end BDShotGroup.low");
+    asm("; CycleBudget begin BDShotGroup.short %0" : : "n"(PulseMath::cyclesShort));
+    asm("; CycleBudget begin BDShotGroup.long %0" : : "n"(PulseMath::cyclesLong));
+
+    port() = on;
+
+    asm("; BDShotGroup Delay A = %0 cycles" : : "I"(PulseMath::delayCyclesA));
+    nopCycles(PulseMath::delayCyclesA);
+
+    asm("; CycleBudget end BDShotGroup.short");
+    port() = b;
+
+    asm("; BDShotGroup Delay B = %0 cycles" : : "I"(PulseMath::delayCyclesB));
+    nopCycles(PulseMath::delayCyclesB);
+
+    asm("; CycleBudget end BDShotGroup.long");
+    asm("; CycleBudget begin BDShotGroup.low %0" : : "n"(PulseMath::cyclesRecover));
+
+    port() = off;
+
+    asm("; BDShotGroup Delay C = %0 cycles" : : "I"(PulseMath::delayCyclesC));
+    nopCycles(PulseMath::delayCyclesC);
+  } while (--n);
+
+  // The low time of the last bit is up to the caller
+  asm("; CycleBudget stop BDShotGroup.low");
+
+  asm volatile("; BDShotGroup::send()#end");
+}
+
+template <AVR::Ports Port, Basic::u1 PinMask, AVR::DShot::Speeds Speed>
+void AVR::DShot::BDShotGroup<Port, PinMask, Speed>::sample(u1 *samples) {
+  asm volatile("; BDShotGroup::sample()");
+
+  BDShotTimer::setShortPeriod(SampleMath::ticks);
+  BDShotTimer::setShortTimeout();
+  BDShotTimer::setCounter(0);
+  BDShotTimer::clearOverflowShortFlag();
+  BDShotTimer::start();
+
+  u1 n = SampleMath::count;
+  do {
+    while (!BDShotTimer::hasOverflowShortFlagged())
+      ;
+    BDShotTimer::clearOverflowShortFlag();
+    *samples++ = pin();
+  } while (--n);
+
+  BDShotTimer::stop();
+
+  asm volatile("; BDShotGroup::sample()#end");
+}
+
+template <AVR::Ports Port, Basic::u1 PinMask, AVR::DShot::Speeds Speed>
+AVR::DShot::Response AVR::DShot::BDShotGroup<Port, PinMask, Speed>::decode(u1 const *const samples, u1 const mask) {
+  u1 i = 0;
+
+  // Wait for initial high-to-low transition
+  while (samples[i] & mask)
+    if (++i == SampleMath::count) return Response::Error::ResponseTimeout;
+
+  MakeResponse::FromRuns frame;
+
+  // The start bit
+  bool level = false;
+  u1 edge = i;
+
+  while (++i < SampleMath::count) {
+    if (bool(samples[i] & mask) == level) continue;
+
+    // Round the run length to a whole number of bits. Anything shorter than a bit is a glitch of at least one bit.
+    u1 bits = (i - edge + SampleMath::Oversample / 2) / SampleMath::Oversample;
+    if (!bits) bits = 1;
+
+    if (frame.add(bits)) break;
+
+    level = !level;
+    edge = i;
+  }
+
+  return frame.finish();
+}
+
+template <AVR::Ports Port, Basic::u1 PinMask, AVR::DShot::Speeds Speed>
+void AVR::DShot::BDShotGroup<Port, PinMask, Speed>::sendCommands(Frame const (&commands)[Motors],
+                                                                 Response (&responses)[Motors]) {
+  // Transpose the frames into one mask per bit while we're still allowed to be slow
+  u1 ones[FrameBits] = {};
+
+  u1 m = 0;
+  for (u1 mask = 1; mask; mask <<= 1) {
+    if (!(PinMask & mask)) continue;
+
+    u1 *b = ones;
+    for (u1 const byte : commands[m++].bytes)
+      for (u1 bit = 0x80; bit; bit >>= 1, b++)
+        if (byte & bit) *b |= mask;
+  }
+
+  static u1 samples[SampleMath::count];
+
+  asm volatile("cli");
+
+  // Other pins on the port keep whatever state they had
+  u1 const off = port() | PinMask;
+  u1 const on = off & ~PinMask;
+
+  // Set output mode only while sending commands
+  ddr() |= PinMask;
+
+  send(ones, on, off);
+
+  // Return pins to input mode
+  ddr() &= ~PinMask;
+
+  sample(samples);
+
+  asm volatile("sei");
+
+  m = 0;
+  for (u1 mask = 1; mask; mask <<= 1)
+    if (PinMask & mask) responses[m++] = decode(samples, mask);
+}
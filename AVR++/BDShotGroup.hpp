@@ -0,0 +1,240 @@
+#pragma once
+
+/**
+ * @brief Port parallel BDShot implementation for AVRs
+ * @file BDShotGroup.hpp
+ * @author Cameron Tacklind <cameron@tacklind.com>
+ *
+ * Talks to up to 8 ESCs that share a single Port in the time it takes to talk to one.
+ *
+ * All of the Commands are transposed into one Port value per bit ahead of time so that sending every frame at once is
+ * just three `out` instructions per bit: all pins asserted, pins sending a "0" released, all pins released.
+ *
+ * Since each ESC answers on its own schedule, we can't recover a clock from one line like `BDShot` does. Instead, the
+ * whole Port is sampled on every Timer0 compare match at a few times the response bit rate, into a RAM buffer. After
+ * the response window closes, each pin is turned back into a 21 bit frame from the run lengths between transitions,
+ * which resyncs on every edge just like `BDShot` does, and then GCR decoded.
+ *
+ * Unlike `BDShot`, interrupts are simply disabled for the whole exchange. No other interrupts need to be disabled
+ * individually.
+ *
+ * Timer0 is shared with `BDShot`. The sample period is set at the start of every exchange, so call `BDShot::init()`
+ * again before using a single `BDShot` on the same chip.
+ *
+ * Simplified API:
+ *
+ * template <AVR::Ports Port, u1 PinMask, AVR::DShot::Speeds Speed = [150/300]>
+ * class AVR::DShot::BDShotGroup {
+ *   static constexpr u1 Motors; // Number of bits set in PinMask
+ *   static void init();
+ *   static void exitBootloader();
+ *   static void startExitBootloader(u2 nowMs); // Non-blocking, see BDShot.hpp
+ *   static bool pollExitBootloader(u2 nowMs);
+ *   static void sendCommands(Command<true> const (&commands)[Motors], Response (&responses)[Motors]);
+ * }
+ *
+ * Motors are numbered by their pin, lowest pin first.
+ *
+ * Usage:
+ *
+ * ```main.cpp
+ * #include <AVR++/BDShotGroup.cpp> // Yes, a cpp file
+ *
+ * using ESCs = AVR::DShot::BDShotGroup<Ports::B, 0b0000'1111>;
+ *
+ * template class AVR::DShot::BDShotGroup<Ports::B, 0b0000'1111>;
+ *
+ * int main() {
+ *   ESCs::init();
+ *
+ *   AVR::DShot::Response responses[ESCs::Motors];
+ *
+ *   while (true) {
+ *     // ~250us for all 4 motors at DSHOT150
+ *     ESCs::sendCommands({0.1, 0.2, 0.3, 0.4}, responses);
+ *
+ *     for (auto &res : responses) {
+ *       if (res.isError()) continue;
+ *       // Do something with the motor telemetry
+ *     }
+ *   }
+ * }
+ * ```
+ *
+ * @see BDShot.hpp for `Response`
+ */
+
+#include "BDShot.hpp"
+#include "Core.hpp"
+
+namespace AVR {
+namespace DShot {
+using namespace AVR;
+using namespace Basic;
+
+template <Ports Port, u1 PinMask, Speeds Speed = NominalSpeed>
+class BDShotGroup {
+  static constexpr u1 countPins(u1 mask) { return mask ? (mask & 1) + countPins(mask >> 1) : 0; }
+
+public:
+  static constexpr u1 Motors = countPins(PinMask);
+
+  static_assert(Motors, "PinMask must select at least one pin");
+
+protected:
+  using Frame = Command<true>;
+
+  static constexpr u1 FrameBits = sizeof(Frame) * 8;
+
+  /**
+   * @brief Cycle math for sending every frame at once
+   *
+   * The sending loop, one iteration per bit:
+   *
+   * C++           // ASM simplified ; Out Notes
+   * ------------- // -------------- ; --- --------
+   * b = *ones++   // ld r, X+       ; I   Could be anywhere in the low time. 2 cycles.
+   * b ^= off      // eor r, off     ; I   Only pins sending a "1" stay asserted
+   * port = on     // out PORT, on   ; A   All pins asserted
+   * delay(A)      // nop x A        ; A
+   * port = b      // out PORT, b    ; A/I Pins sending "0" released
+   * delay(B)      // nop x B        ; A/I
+   * port = off    // out PORT, off  ; I   All pins released
+   * delay(C)      // nop x C        ; I
+   * n--           // dec            ; I
+   * if (n)        // brne           ; I   2 clock cycles when looping
+   *
+   * Notice that every bit takes the same amount of time, regardless of the data.
+   */
+  struct PulseMath {
+    static constexpr unsigned cyclesShort = Const::round(F_CPU * (pulseNanos0(Speed) / 1e9));
+    static constexpr unsigned cyclesLong = Const::round(F_CPU * (pulseNanos0(Speed) * 2 / 1e9));
+    static constexpr unsigned cyclesBit = Const::round(F_CPU * (pulseNanos0(Speed) * 8 / 3 / 1e9));
+    static constexpr unsigned cyclesRecover = cyclesBit - cyclesLong;
+
+    static constexpr unsigned minCyclesShort = 1;
+    static constexpr unsigned minCyclesLong = 1;
+    static constexpr unsigned minCyclesRecover = 7;
+
+    static_assert(cyclesShort >= minCyclesShort, "Short pulse is too short for this F_CPU");
+    static_assert(cyclesLong - cyclesShort >= minCyclesLong, "Long pulse is too short for this F_CPU");
+    static_assert(cyclesRecover >= minCyclesRecover, "Recovery time is too short for this F_CPU");
+
+    static constexpr unsigned delayCyclesA = cyclesShort - minCyclesShort;
+    static constexpr unsigned delayCyclesB = cyclesLong - cyclesShort - minCyclesLong;
+    static constexpr unsigned delayCyclesC = cyclesRecover - minCyclesRecover;
+  };
+
+  /**
+   * @brief Cycle math for sampling the whole Port
+   *
+   * The sampling loop, one iteration per sample:
+   *
+   * C++                       // ASM simplified     ; Notes
+   * ------------------------- // ------------------ ; --------
+   * while (!flagged())        // sbis TIFR0, OCF0A  ; 3 cycles per check, 2 when we fall out
+   *                           // rjmp .-4           ;
+   * clearFlag()               // sbi TIFR0, OCF0A   ; 2 cycles
+   * *samples++ = PIN          // in r, PIN          ; 1 cycle. This is the moment we sample.
+   *                           // st X+, r           ; 2 cycles
+   * n--                       // dec                ; 1 cycle
+   * if (n)                    // brne               ; 2 cycles when looping
+   *
+   * The timer keeps running while we work so the samples stay evenly spaced, give or take a polling loop.
+   */
+  struct SampleMath {
+    static constexpr unsigned pollCycles = Core::Ticks::Instruction::Skip1Word - 1 + Core::Ticks::Instruction::RJmp;
+    static constexpr unsigned loopCycles = Core::Ticks::Instruction::Skip1Word + // Fall out of polling loop
+                                           2 +                                   // sbi; Clear flag
+                                           1 +                                   // in; Sample
+                                           2 +                                   // st; Store
+                                           1 +                                   // dec
+                                           Core::Ticks::Instruction::Branch +    // Loop
+                                           0;
+
+    static constexpr double bitTicks = responseBitNanos(Speed) * F_CPU / 1e9;
+
+    static constexpr unsigned ticksForOversample(unsigned n) { return Const::round(bitTicks / n); }
+    static constexpr bool canOversample(unsigned n) { return ticksForOversample(n) >= loopCycles + pollCycles; }
+
+    /**
+     * More samples per bit give more margin against clock drift. 3 is the minimum that reliably tells a run of 3 bits
+     * from a run of 2.
+     */
+    static constexpr unsigned Oversample = canOversample(4) ? 4 : 3;
+
+    static_assert(canOversample(Oversample), "Port can't be sampled fast enough for this Speed at this F_CPU");
+
+    static constexpr unsigned ticks = ticksForOversample(Oversample);
+
+    static_assert(ticks < 0x100, "Sample period is too long for an 8-bit timer");
+
+    static constexpr double sampleNanos = ticks * 1e9 / F_CPU;
+
+    /**
+     * Long enough for the slowest ESC allowed by `responseTimeout` to finish sending its frame, plus a bit of slack.
+     */
+    static constexpr double windowNanos = BDShotConfig::responseTimeout * 1e3 + (21 + 1) * responseBitNanos(Speed);
+
+    static constexpr unsigned count = Const::round(windowNanos / sampleNanos + 0.5);
+
+    static_assert(count < 0x100, "Sample buffer is too large for this implementation");
+  };
+
+  static BootloaderDeadline bootloader;
+
+  static inline volatile u1 &port() { return *(volatile u1 *)u1(Port); }
+  static inline volatile u1 &ddr() { return *(volatile u1 *)(u1(Port) - 1); }
+  static inline volatile u1 &pin() { return *(volatile u1 *)(u1(Port) - 2); }
+
+  /**
+   * @brief Send every frame at once, one Port value per bit
+   *
+   * @param ones One mask per bit, MSB first, of the pins sending a "1"
+   * @param on The Port value with all of our pins asserted
+   * @param off The Port value with all of our pins released (idle)
+   */
+  static void send(u1 const *ones, u1 on, u1 off);
+
+  /**
+   * @brief Sample the whole Port at a fixed rate until the response window closes
+   */
+  static void sample(u1 *samples);
+
+  /**
+   * @brief Rebuild a single motor's frame from the samples and decode it
+   *
+   * @param samples Buffer filled by `sample()`
+   * @param mask The single pin to decode
+   */
+  static Response decode(u1 const *samples, u1 mask);
+
+public:
+  static void init();
+  static void exitBootloader();
+
+  /**
+   * @brief Pull every line low and return right away
+   * @see BDShot::startExitBootloader()
+   */
+  static void startExitBootloader(u2 nowMs);
+
+  /**
+   * @return true once every line has been released and commands can be sent
+   * @see BDShot::pollExitBootloader()
+   */
+  static bool pollExitBootloader(u2 nowMs);
+
+  /**
+   * @brief Send a Command to every motor and read every response
+   *
+   * Interrupts are disabled for the duration (~250us at DSHOT150) regardless of how many motors there are.
+   *
+   * @param commands One Command per motor, lowest pin first
+   * @param responses One Response per motor, lowest pin first
+   */
+  static void sendCommands(Frame const (&commands)[Motors], Response (&responses)[Motors]);
+};
+
+} // namespace DShot
+} // namespace AVR
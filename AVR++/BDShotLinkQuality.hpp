@@ -0,0 +1,125 @@
+#pragma once
+
+/**
+ * @brief Per ESC counters of how well BDShot responses are being received
+ * @file BDShotLinkQuality.hpp
+ * @author Cameron Tacklind <cameron@tacklind.com>
+ *
+ * Every Response is counted by its `Response::Error`, a moving average of the success ratio is kept, and the time from
+ * the end of our command to the ESC's start bit goes into a histogram.
+ *
+ * @see BDShotTurnaround.hpp for how that time is measured
+ *
+ * Enabled with `BDShotConfig::LinkStats::enabled`. When disabled, every function is empty and there is no storage.
+ *
+ * Counters are 16 bits and wrap. Take differences between snapshots.
+ *
+ * Usage:
+ *
+ * ```C++
+ * auto res = ESC::sendCommand(0.5);
+ *
+ * // Later, outside of sendCommand()
+ * auto stats = ESC::getLinkQuality();
+ * // Send stats over USART
+ * ```
+ */
+
+#include "BDShotConfig.hpp"
+#include "BDShotResponse.hpp"
+#include "basicTypes.hpp"
+
+namespace AVR {
+namespace DShot {
+using namespace Basic;
+
+struct LinkSnapshot {
+  /**
+   * Frames by `Response::Error`. `frames[0]` is good frames.
+   */
+  u2 frames[Response::ErrorKinds];
+
+  /**
+   * Turnaround times, in buckets of `LinkQuality::LatencyBinTicks` CPU cycles. The last bucket includes everything
+   * longer. Timeouts aren't counted.
+   */
+  u2 latency[BDShotConfig::LinkStats::latencyBins];
+
+  /**
+   * Recent fraction of good frames. 0xffff is 100%.
+   */
+  u2 successRatio;
+};
+
+/**
+ * @brief The smallest shift that fits a whole waiting window in the histogram
+ */
+constexpr u1 latencyBinShift(unsigned windowTicks) {
+  u1 s = 0;
+  while ((windowTicks >> s) >= BDShotConfig::LinkStats::latencyBins)
+    s++;
+  return s;
+}
+
+/**
+ * @tparam ESC Anything unique to the ESC, so each one gets its own counters
+ * @tparam WindowTicks How long the receiver waits for the start bit
+ */
+template <typename ESC, unsigned WindowTicks, bool Enabled = BDShotConfig::LinkStats::enabled>
+class LinkQuality {
+  static LinkSnapshot counts;
+
+public:
+  static constexpr bool enabled = true;
+  static constexpr u1 LatencyBinShift = latencyBinShift(WindowTicks);
+  static constexpr u2 LatencyBinTicks = 1 << LatencyBinShift;
+
+  /**
+   * @param r The Response to count
+   * @param turnaroundTicks From the end of the command to the start bit. Ignored for timeouts.
+   */
+  static void record(Response r, u2 turnaroundTicks) {
+    auto const e = r.getError();
+    counts.frames[u1(e)]++;
+
+    using BDShotConfig::LinkStats::successRatioShift;
+    if (e == Response::Error::None)
+      counts.successRatio += u2(0xffff - counts.successRatio) >> successRatioShift;
+    else
+      counts.successRatio -= counts.successRatio >> successRatioShift;
+
+    if (e == Response::Error::ResponseTimeout) return;
+
+    u2 bin = turnaroundTicks >> LatencyBinShift;
+    if (bin >= BDShotConfig::LinkStats::latencyBins) bin = BDShotConfig::LinkStats::latencyBins - 1;
+    counts.latency[bin]++;
+  }
+
+  /**
+   * Don't call while a response is being received, like from an interrupt that could interrupt `sendCommand()`
+   */
+  inline static LinkSnapshot snapshot() { return counts; }
+
+  inline static void reset() { counts = {}; }
+};
+
+/**
+ * Compiled out
+ */
+template <typename ESC, unsigned WindowTicks>
+class LinkQuality<ESC, WindowTicks, false> {
+public:
+  static constexpr bool enabled = false;
+  static constexpr u1 LatencyBinShift = latencyBinShift(WindowTicks);
+  static constexpr u2 LatencyBinTicks = 1 << LatencyBinShift;
+
+  inline static void record(Response, u2) {}
+  inline static LinkSnapshot snapshot() { return {}; }
+  inline static void reset() {}
+};
+
+template <typename ESC, unsigned WindowTicks, bool Enabled>
+LinkSnapshot LinkQuality<ESC, WindowTicks, Enabled>::counts;
+
+} // namespace DShot
+} // namespace AVR
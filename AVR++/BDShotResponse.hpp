@@ -0,0 +1,247 @@
+#pragma once
+
+/**
+ * @brief The response from the ESC in BDShot, and how to build one from received bits
+ * @file BDShotResponse.hpp
+ * @author Cameron Tacklind <cameron@tacklind.com>
+ *
+ * Free of hardware dependencies so host side tools, like BDShotSim.hpp, decode exactly like the chip.
+ *
+ * @see BDShot.hpp
+ */
+
+#include "BDShotConfig.hpp"
+#include "GCR.hpp"
+#include "Reciprocal.hpp"
+
+namespace AVR {
+namespace DShot {
+using namespace Basic;
+
+class Response {
+public:
+  constexpr static unsigned BaseBits = 9;
+  constexpr static unsigned ExponentBits = 3;
+  constexpr static u1 ExponentMax = 1 << ExponentBits;
+  constexpr static u1 ExponentTop = ExponentMax - 1;
+  constexpr static u1 ExponentMask = ExponentMax - 1;
+
+private:
+  u1 lsb;
+  u1 msb;
+
+  constexpr static u1 ErrorMask = 1 << 7;
+
+public:
+  enum class Error : u1 {
+    None,
+    ResponseTimeout,
+    BadDecodeFirstNibble,
+    BadDecodeSecondNibble,
+    BadDecodeThirdNibble,
+    BadDecodeFourthNibble,
+    BadChecksum,
+    // An edge of the response came while BDShotCapture wasn't looking for it
+    MissedEdge,
+  };
+
+  /**
+   * Number of `Error` values, including `None`
+   */
+  constexpr static u1 ErrorKinds = static_cast<u1>(Error::MissedEdge) + 1;
+
+  /**
+   * Error by default
+   */
+  inline constexpr Response(Error e = Error::ResponseTimeout) : lsb(static_cast<u1>(e)), msb(ErrorMask) {}
+  /**
+   * @param rpmPeriodBase
+   * @param rpmPeriodExponent
+   */
+  inline constexpr Response(u1 lsb, u1 msb) : lsb(lsb), msb(msb) {}
+
+  /**
+   * @return true if there was an error
+   */
+  inline bool constexpr isError() const { return msb & ErrorMask; }
+
+  inline constexpr operator bool() const { return !isError(); }
+
+  inline Error constexpr getError() const {
+    if (!isError()) return Error::None;
+    return static_cast<Error>(lsb);
+  }
+
+  /**
+   * @brief Check if this packet is a telemetry packet.
+   *
+   * Do not use if this is an error Response.
+   *
+   * @return true
+   * @return false
+   */
+  inline bool constexpr isExtendedTelemetry() const { return BDShotConfig::supportEDT && !(msb & 1); }
+
+  enum class Telemetry : u1 {
+    None = 0x00,
+    Temperature = 0x02,
+    Voltage = 0x04,
+    Current = 0x06,
+    Debug1 = 0x08,
+    Debug2 = 0x0A,
+    Debug3 = 0x0C,
+    State_Event = 0x0E,
+  };
+  inline Telemetry constexpr getTelemetryType() const { return static_cast<Telemetry>(msb); }
+
+  inline u1 constexpr getTelemetryValue() const { return BDShotConfig::supportEDT ? lsb : -1; }
+
+  inline constexpr u2 getBase() const { return (u2(BDShotConfig::supportEDT | (msb & 1)) << 8) | lsb; }
+  inline constexpr u2 getExponent() const {
+    // Don't need to mask because it's not an error
+    return msb >> 1;
+  }
+
+  inline u2 constexpr getPeriodMicros() const { return getBase() << getExponent(); }
+
+  inline constexpr operator u2() const { return getPeriodMicros(); }
+
+  /**
+   * @brief Convert internal notation to float rpm
+   * @warning Check there is no error before calling this function
+   *
+   * @details
+   *                 1 Electrical Revolution           1e6 us   60 seconds
+   * speed = --------------------------------------- * ------ * ----------
+   *         (rpmPeriodBase << rpmPeriodExponent) us   second     minute
+   *
+   *                       60 * 1e6               Electrical Revolutions
+   *       = ------------------------------------ ---------per----------
+   *         (rpmPeriodBase << rpmPeriodExponent)         minute
+   *
+   * @return float eRPM of motor
+   */
+  inline float constexpr getRPM(u1 polePairs = 1) const { return 60e6 / (u3(polePairs) * getPeriodMicros()); }
+
+  /**
+   * @brief Like `getRPM()` but without any division. Rounded to the nearest eRPM.
+   * @warning Check there is no error before calling this function
+   * @see Reciprocal.hpp for accuracy
+   */
+  inline u3 getERPM() const { return Reciprocal::divide<60000000>(getBase(), getExponent()); }
+
+  /**
+   * @brief Mechanical RPM without any division. Rounded to the nearest RPM.
+   * @warning Check there is no error before calling this function
+   * @tparam PolePairs Number of magnet pole pairs in the motor. Each value used costs a 512 byte table.
+   */
+  template <u1 PolePairs>
+  inline u3 getMechanicalRPM() const {
+    return Reciprocal::divide<60000000, PolePairs>(getBase(), getExponent());
+  }
+
+  /**
+   * @brief Revolutions per second without any division. Rounded to the nearest Hz.
+   * @warning Check there is no error before calling this function
+   * @tparam PolePairs Number of magnet pole pairs in the motor, or 1 for electrical revolutions
+   */
+  template <u1 PolePairs = 1>
+  inline u3 getHz() const {
+    return Reciprocal::divide<1000000, PolePairs>(getBase(), getExponent());
+  }
+
+  inline bool constexpr isStopped() const { return msb == 0x0f && lsb == 0xff; }
+};
+
+} // namespace DShot
+} // namespace AVR
+
+namespace MakeResponse {
+
+inline static constexpr bool isBadChecksum(Basic::u1 n3, Basic::u1 n2, Basic::u1 n1, Basic::u1 n0) {
+  return 0xf ^ n0 ^ n1 ^ n2 ^ n3;
+}
+
+/**
+ * @brief Turn the 20 raw bits received after the start bit into a Response
+ *
+ * Same math as the end of bitByBit() but in plain C++ for receivers that don't need to keep everything in registers.
+ *
+ * @param raw The received (still shift-encoded) bits, MSB first, in the lower 20 bits
+ */
+inline static AVR::DShot::Response fromRawBits(Basic::u3 raw) {
+  using namespace AVR::DShot;
+
+  // Undo the shifting. The start bit is always 0 so a 0 shifted in from the top is correct.
+  Basic::u3 const gcr = raw ^ (raw >> 1);
+
+  if (BDShotConfig::gcrDecoder != GCR::Decoder::Switch) {
+    // Fast path. Decode all 4 quintets in one pass and only check them all at once.
+    Basic::u3 const word = GCR::decodeWord<BDShotConfig::gcrDecoder>(gcr);
+
+    if (!GCR::isInvalidWord(word)) {
+      Basic::u1 check = Basic::u1(word >> 8) ^ Basic::u1(word);
+      check ^= check >> 4;
+      if ((check & GCR::outMask) != GCR::outMask) return Response::Error::BadChecksum;
+
+      return {Basic::u1(word >> 4), Basic::u1(word >> 12)};
+    }
+
+    // Something is wrong. Take the slow path to find out which quintet it was.
+  }
+
+  Basic::u1 const n0 = GCR::decode(Basic::u1(gcr >> (GCR::inBits * 0)) & GCR::inMask);
+  Basic::u1 const n1 = GCR::decode(Basic::u1(gcr >> (GCR::inBits * 1)) & GCR::inMask);
+  Basic::u1 const n2 = GCR::decode(Basic::u1(gcr >> (GCR::inBits * 2)) & GCR::inMask);
+  Basic::u1 const n3 = GCR::decode(Basic::u1(gcr >> (GCR::inBits * 3)) & GCR::inMask);
+
+  // Yes, this order is correct. They are numbered by significance, and MSB was first.
+  if (n3 == 0xff) return Response::Error::BadDecodeFirstNibble;
+  if (n2 == 0xff) return Response::Error::BadDecodeSecondNibble;
+  if (n1 == 0xff) return Response::Error::BadDecodeThirdNibble;
+  if (n0 == 0xff) return Response::Error::BadDecodeFourthNibble;
+
+  if (isBadChecksum(n3, n2, n1, n0)) return Response::Error::BadChecksum;
+
+  return {Basic::u1(n1 | (n2 << 4)), n3};
+}
+
+/**
+ * @brief Rebuild a response from the number of bits between each transition
+ *
+ * For receivers that can't sample each bit directly, but can measure how long the line stays at each level.
+ * Starts with the start bit, which is always low, and alternates levels on every call to `add()`.
+ */
+class FromRuns {
+  // A start bit and 20 raw bits. Like in getResponse(), a set bit marks that we've gotten all of them.
+  static constexpr Basic::u3 FinishedMarker = Basic::u3(1) << 21;
+
+  Basic::u3 raw = 1;
+
+  // The start bit
+  bool level = false;
+
+public:
+  /**
+   * @param bits Number of bits the line stayed at the current level
+   * @return true once all 21 bits have been received
+   */
+  inline bool add(Basic::u1 bits) {
+    while (bits-- && raw < FinishedMarker)
+      raw = raw << 1 | level;
+
+    level = !level;
+
+    return raw >= FinishedMarker;
+  }
+
+  inline AVR::DShot::Response finish() {
+    // The line idles high after the frame so the last run doesn't have a closing transition
+    while (raw < FinishedMarker)
+      raw = raw << 1 | level;
+
+    // Drop the marker and the start bit
+    return fromRawBits(raw & ((FinishedMarker >> 1) - 1));
+  }
+};
+} // namespace MakeResponse
@@ -0,0 +1,308 @@
+#pragma once
+
+/**
+ * @brief Host side simulator of the `BDShot` receiver, for measuring bit error rates
+ * @file BDShotSim.hpp
+ * @author Cameron Tacklind <cameron@tacklind.com>
+ *
+ * Runs on a PC, not on the chip.
+ *
+ * Generates random ESC responses: GCR encoded, shift encoded, 21 bits with the start bit. The ESC's clock can drift,
+ * every edge can jitter, and short glitches can be added. Each response is fed to a cycle level model of
+ * `BDShot::getResponse()` and `ReadBitISR()`: the spin loops, the ISR that samples each bit, and the timer resync on
+ * every transition. The model uses the same timing values as the chip (BDShotTiming.hpp) and the same decoder
+ * (BDShotResponse.hpp).
+ *
+ * The model doesn't know about every cycle on the chip. What it's good for is comparing: drift and jitter tolerance
+ * of different `BDShotConfig::fudgeInitialTicks`/`fudgeSyncTicks`, Speeds, and F_CPUs, from data.
+ *
+ * Usage:
+ *
+ * ```sim.cpp
+ * #include <AVR++/BDShotSim.hpp>
+ *
+ * using namespace AVR::DShot;
+ *
+ * int main() {
+ *   Sim::Channel ch;
+ *   ch.bitTicks = 4e9 / 300e3 / 5 * 16e6 / 1e9; // DSHOT300 at 16MHz
+ *   ch.turnaroundTicks = 30 * 16;               // 30us
+ *   ch.timeoutTicks = BDShotConfig::responseTimeout * 16;
+ *
+ *   for (int drift = -10; drift <= 10; drift++) {
+ *     ch.drift = drift / 100.0;
+ *     // Try other fudge values here
+ *     auto stats = Sim::run<ReceiveTiming<43, 21, 0, 0>>(ch, 100000);
+ *     Sim::print(stats);
+ *   }
+ * }
+ * ```
+ *
+ * `g++ -std=c++17 -I path/to/AVR++ sim.cpp`
+ */
+
+#ifdef __AVR__
+#error "BDShotSim.hpp is for host side tools"
+#endif
+
+#include "BDShotResponse.hpp"
+#include "BDShotTiming.hpp"
+#include <cstdio>
+#include <cstring>
+#include <random>
+#include <vector>
+
+namespace AVR {
+namespace DShot {
+namespace Sim {
+using namespace Basic;
+
+/**
+ * @brief How the ESC and the wire mangle the response. All times are in CPU cycles of the receiver.
+ */
+struct Channel {
+  // Nominal length of a response bit
+  double bitTicks = 0;
+  // ESC clock error, as a fraction. Positive is slow. 0.02 is 2% slow.
+  double drift = 0;
+  // Standard deviation of the time of every edge
+  double jitterTicks = 0;
+  // Chance, per bit, of a glitch somewhere in it
+  double glitchRate = 0;
+  // How long each glitch lasts
+  double glitchTicks = 1;
+  // From the end of our command to the start bit of the response
+  double turnaroundTicks = 0;
+  // How long we wait for the start bit
+  double timeoutTicks = 0;
+};
+
+struct Stats {
+  unsigned long frames = 0;
+
+  // Every received bit compared to what was sent. Frames that timed out aren't counted.
+  unsigned long bits = 0;
+  unsigned long bitErrors = 0;
+
+  // By `Response::Error`. `errors[0]` counts good frames.
+  unsigned long errors[Response::ErrorKinds] = {};
+
+  // Frames that decoded without error but to the wrong value. These are the dangerous ones.
+  unsigned long wrongValues = 0;
+
+  double bitErrorRate() const { return bits ? double(bitErrors) / bits : 0; }
+  double frameErrorRate() const { return frames ? 1 - double(errors[0] - wrongValues) / frames : 0; }
+};
+
+/**
+ * @brief The line level over time. Starts high (idle).
+ */
+class Waveform {
+  // Times the level toggles, in order
+  std::vector<double> edges;
+
+public:
+  inline void clear() { edges.clear(); }
+  inline void toggleAt(double t) { edges.push_back(t); }
+
+  inline bool isHigh(double t) const {
+    bool high = true;
+    for (auto e : edges) {
+      if (e > t) break;
+      high = !high;
+    }
+    return high;
+  }
+
+  inline void sort() {
+    // Jitter and glitches can reorder edges. Insertion sort since they're nearly sorted already.
+    for (std::size_t i = 1; i < edges.size(); i++)
+      for (std::size_t j = i; j && edges[j - 1] > edges[j]; j--)
+        std::swap(edges[j - 1], edges[j]);
+  }
+};
+
+/**
+ * @brief GCR encode a nibble by searching the decoder, so they can't disagree
+ */
+inline u1 encodeNibble(u1 nibble) {
+  for (u1 gcr = 0; gcr < GCR::inCeiling; gcr++)
+    if (GCR::decode(gcr) == nibble) return gcr;
+  return 0;
+}
+
+/**
+ * @brief The 20 raw bits an ESC would send after the start bit, MSB first
+ *
+ * @param value 12 bits: exponent, telemetry flag, and base
+ */
+inline u3 encode(u2 value) {
+  u1 const crc = ~(value ^ (value >> 4) ^ (value >> 8)) & GCR::outMask;
+  u2 const frame = value << 4 | crc;
+
+  u3 gcr = 0;
+  for (signed char n = 3; n >= 0; n--)
+    gcr = gcr << GCR::inBits | encodeNibble((frame >> (n * 4)) & GCR::outMask);
+
+  // Undo gcr = raw ^ (raw >> 1), from the top. The start bit above the 20 bits is always 0.
+  u3 raw = 0;
+  bool previous = false;
+  for (signed char i = 19; i >= 0; i--) {
+    previous ^= (gcr >> i) & 1;
+    raw |= u3(previous) << i;
+  }
+
+  return raw;
+}
+
+/**
+ * @brief Run one response through a cycle level model of the receiver
+ *
+ * @tparam Timing The ReceiveTiming the chip would use
+ * @param line The response
+ * @param timeoutTicks When to give up waiting for the start bit
+ * @param phase Where the initial spin loop is when the command ends, in [0, 1)
+ * @param raw Set to the 20 bits sampled, MSB first
+ * @return false if no start bit was seen in time
+ */
+template <typename Timing>
+bool receive(Waveform const &line, double timeoutTicks, double phase, u3 &raw) {
+  constexpr unsigned P = Timing::P;
+
+  // Ticks from setting the counter to the compare match, including counting past TOP to 0xff
+  auto ticksUntilCompare = [](u1 counter) -> double { return counter < P ? P - counter : 0x100 - counter + P; };
+
+  // Wait for the start bit
+  double t = phase * Timing::ticksInitialSpinLoop;
+  while (line.isHigh(t)) {
+    if (t > timeoutTicks) return false;
+    t += Timing::ticksInitialSpinLoop;
+  }
+
+  double set = t + Timing::ticksFromTransitionToInitialTimerSync;
+  double compare = set + ticksUntilCompare(Timing::timerCounterValueInitial);
+
+  // Where the spin loop polls next
+  t = set;
+  bool waitingForHigh = true;
+  u1 samples = 0;
+  raw = 0;
+
+  auto isr = [&] {
+    double const sample = compare + Timing::ticksFromOverflowToISRSample;
+    raw = raw << 1 | line.isHigh(sample);
+    samples++;
+    compare += P;
+    return sample + Timing::ticksFromISRSampleToSpinLoop;
+  };
+
+  while (samples < 20) {
+    if (compare <= t) {
+      t = isr();
+      continue;
+    }
+
+    if (line.isHigh(t) != waitingForHigh) {
+      t += Timing::ticksSpinLoop;
+      continue;
+    }
+
+    // Saw a transition. The ISR can still get in before we set the counter.
+    set = t + Timing::ticksFromTransitionToTimerSync;
+    if (compare < set) {
+      double const before = compare;
+      set += isr() - before;
+      if (samples == 20) break;
+    }
+
+    compare = set + ticksUntilCompare(Timing::timerCounterValueSync);
+    waitingForHigh = !waitingForHigh;
+    t = set;
+  }
+
+  return true;
+}
+
+/**
+ * @brief Send random responses through a Channel and count what the receiver makes of them
+ *
+ * @tparam Timing The ReceiveTiming the chip would use
+ * @param ch How to mangle each response
+ * @param frames How many responses to try
+ * @param seed For repeatable runs
+ */
+template <typename Timing>
+Stats run(Channel const &ch, unsigned long frames, unsigned seed = 1) {
+  std::mt19937 rng(seed);
+  std::uniform_real_distribution<double> uniform(0, 1);
+  std::normal_distribution<double> jitter(0, ch.jitterTicks ? ch.jitterTicks : 1);
+  std::uniform_int_distribution<unsigned> values(0, 0xfff);
+
+  auto const bit = ch.bitTicks * (1 + ch.drift);
+
+  Stats s;
+  Waveform line;
+
+  for (unsigned long f = 0; f < frames; f++) {
+    u3 const sent = encode(values(rng));
+
+    // Start bit, the 20 bits, and back to idle high
+    line.clear();
+    bool level = false;
+    for (u1 i = 0; i <= 21; i++) {
+      bool const next = i == 21 ? true : i == 0 ? false : (sent >> (20 - i)) & 1;
+      if (i == 0 || next != level) {
+        line.toggleAt(ch.turnaroundTicks + i * bit + (ch.jitterTicks ? jitter(rng) : 0));
+        level = next;
+      }
+    }
+
+    for (u1 i = 0; i < 21; i++) {
+      if (uniform(rng) >= ch.glitchRate) continue;
+      double const at = ch.turnaroundTicks + (i + uniform(rng)) * bit;
+      line.toggleAt(at);
+      line.toggleAt(at + ch.glitchTicks);
+    }
+
+    line.sort();
+
+    s.frames++;
+
+    u3 received;
+    if (!receive<Timing>(line, ch.timeoutTicks, uniform(rng), received)) {
+      s.errors[unsigned(Response::Error::ResponseTimeout)]++;
+      continue;
+    }
+
+    s.bits += 20;
+    for (u3 diff = received ^ sent; diff; diff &= diff - 1)
+      s.bitErrors++;
+
+    auto const res = MakeResponse::fromRawBits(received);
+    s.errors[unsigned(res.getError())]++;
+
+    if (res.isError()) continue;
+
+    auto const expected = MakeResponse::fromRawBits(sent);
+    if (std::memcmp(&res, &expected, sizeof(res))) s.wrongValues++;
+  }
+
+  return s;
+}
+
+inline void print(Stats const &s, std::FILE *out = stdout) {
+  static char const *const names[Response::ErrorKinds] = {
+      "None", "ResponseTimeout", "BadDecodeFirstNibble", "BadDecodeSecondNibble", "BadDecodeThirdNibble",
+      "BadDecodeFourthNibble", "BadChecksum", "MissedEdge",
+  };
+
+  std::fprintf(out, "frames %lu, BER %.3g, FER %.3g, wrong values %lu\n", s.frames, s.bitErrorRate(),
+               s.frameErrorRate(), s.wrongValues);
+
+  for (unsigned i = 0; i < Response::ErrorKinds; i++)
+    if (s.errors[i]) std::fprintf(out, "  %-22s %lu\n", names[i], s.errors[i]);
+}
+
+} // namespace Sim
+} // namespace DShot
+} // namespace AVR
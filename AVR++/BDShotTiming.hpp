@@ -0,0 +1,207 @@
+#pragma once
+
+/**
+ * @brief The cycle budget model of the `BDShot` receiver
+ * @file BDShotTiming.hpp
+ * @author Cameron Tacklind <cameron@tacklind.com>
+ *
+ * Everything `BDShot::getResponse()` needs to know about how long its own code takes, solved at compile time into the
+ * values it loads into Timer0.
+ *
+ * Free of hardware dependencies so BDShotSim.hpp can run the exact same numbers on a host.
+ *
+ * The spin loop and resync counts are marked in `getResponse()` for tools/cycle-budget.py to check.
+ *
+ * @see The comments in BDShot::getResponse() for how the receiver works.
+ */
+
+#include "BDShotConfig.hpp"
+#include "Const.hpp"
+#include "CoreTicks.hpp"
+#include "basicTypes.hpp"
+
+namespace AVR {
+namespace DShot {
+using namespace Basic;
+
+/**
+ * @tparam PeriodTicks CPU cycles per response bit
+ * @tparam HalfPeriodTicks CPU cycles per half response bit, rounded
+ * @tparam FudgeInitialTicks Larger numbers make the first sample happen sooner
+ * @tparam FudgeSyncTicks Larger numbers make every other sample happen sooner
+ */
+template <unsigned PeriodTicks, unsigned HalfPeriodTicks, int FudgeInitialTicks = BDShotConfig::fudgeInitialTicks,
+          int FudgeSyncTicks = BDShotConfig::fudgeSyncTicks>
+struct ReceiveTiming {
+  static constexpr bool useDebounce = BDShotConfig::useDebounce;
+
+  /**
+   * Number of ticks from timer overflow to when we execute the instruction that samples the pin's input state.
+   *
+   * This comes mostly from 3 separate places:
+   * - The AVR datasheet which specified ISR handling takes 5 clock cycles to execute.
+   * - The de facto standard JMP table as the first instructions in the ISR (could be eliminated with a custom .init)
+   * - Other instructions in the ISR before sampling the pin into a temp register
+   */
+  static constexpr unsigned ticksFromOverflowToISRSample =
+      AVR::Core::Ticks::Hardware::ISR +     // ISR time
+      AVR::Core::Ticks::Instruction::Jmp +  // Initial jmp table, could be eliminated with a custom .init table but as
+                                            // long as it's predictable, do we care?
+      BDShotConfig::Debug::EmitPulseAtISR + // Pin toggle adds a clock cycle
+      AVR::Core::Ticks::Instruction::IJmp + // Our jmp to Z
+      0;
+
+  /**
+   * Number of ticks it takes the initial spin loop to check for the initial high-to-low transition.
+   *
+   * Most of the time, this number is used.
+   *
+   * Sometimes, the timer has overflowed and we need to check that our timeout counter hasn't reached zero.
+   * In this case, we chance being slightly more out of sync than normal. So we use the largest Timer period possible.
+   * In any case, it will resync on the next bit transition.
+   *
+   * @see `ticksInitialSpinLoopWorstCase`
+   *
+   * @note Maximum accuracy we can achieve of timing on initial transition
+   * @note These lists are generated from looking at the generated assembly for these functions.
+   */
+  static constexpr unsigned ticksInitialSpinLoop =
+      AVR::Core::Ticks::Instruction::Skip1Word +                // Check Pin, skip over rjmp to normal
+      BDShotConfig::ResetWatchdog::WaitingFirstTransitionFast + // WDR
+      1 +                                                       // Didn't overflow
+      AVR::Core::Ticks::Instruction::RJmp +                     // Loop
+      0;
+
+  /**
+   * Number of ticks it takes the initial spin loop to check for the initial high-to-low transition while also
+   * decrementing and checking the timer overflow counter.
+   *
+   * This value is not used but computed for reference.
+   *
+   * @note Maximum accuracy we can achieve of timing on initial transition
+   * @note These lists are generated from looking at the generated assembly for these functions.
+   */
+  static constexpr unsigned ticksInitialSpinLoopWorstCase =
+      AVR::Core::Ticks::Instruction::Skip1Word +                         // Check Pin, skip over rjmp to normal
+      BDShotConfig::ResetWatchdog::WaitingFirstTransitionFast +          // WDR
+      AVR::Core::Ticks::Instruction::Skip1Word +                         // Check Overflow Flag
+      1 +                                                                // subi; i--
+      1 +                                                                // breq; if (i == 0) {<exit path>} else ...
+      1 +                                                                // sbi; clear timer flag by setting it
+      BDShotConfig::ResetWatchdog::WaitingFirstTransitionTimerOverflow + // WDR
+      AVR::Core::Ticks::Instruction::RJmp +                              // Back to main loop
+      0;
+
+  static_assert(ticksInitialSpinLoopWorstCase < ticksInitialSpinLoop * 3,
+                "ticksInitialSpinLoopWorstCase is curiously large");
+
+  /**
+   * Number of ticks from the initial high-to-low transition to when we can set the timer to some value.
+   *
+   * @note Part of the phase adjustment of reading bits on timer overflow
+   * @note These lists are generated from looking at the generated assembly for these functions.
+   */
+  static constexpr unsigned ticksFromTransitionToInitialTimerSync =
+      AVR::Core::Ticks::Instruction::Skip1Word * useDebounce + // Debounce compensation
+      1 +                                                      // Check Pin  with `sbis`, it's low, don't skip
+      AVR::Core::Ticks::Instruction::RJmp +                    // Jump to Initial Ticks
+      BDShotConfig::ResetWatchdog::ReceivedFirstTransition +   // WDR
+      BDShotConfig::captureTurnaround +                        // `in` the counter to measure the turnaround
+      AVR::Core::Ticks::Instruction::LoaDImediate +            // Set register to immediate
+      AVR::Core::Ticks::Instruction::Out +                     // Set timer counter from register
+      0;
+
+  /**
+   * Number of ticks it takes the ultra fast main spin loop to check for a transition
+   *
+   * @note Maximum accuracy we can achieve of timing on transition
+   */
+  static constexpr unsigned ticksSpinLoop =
+      BDShotConfig::Debug::EmitPulsesAtIdle + // Pin toggle adds a clock cycle to the loop
+      1 +                                     // Reading the pin state takes 1 clock cycle
+      AVR::Core::Ticks::Instruction::RJmp +   // Jump to start of loop
+      0;
+
+  /**
+   * Number of ticks from a transition to when we can set the timer to some value.
+   * Receiving bits has a different code path that the initial transition.
+   *
+   * @note Part of the phase adjustment of reading bits on timer overflow
+   */
+  static constexpr unsigned ticksFromTransitionToTimerSync =
+      AVR::Core::Ticks::Instruction::Skip1Word * useDebounce + // Debounce compensation
+      AVR::Core::Ticks::Instruction::Skip1Word +               // Read + skip rjmp for loop[]
+      AVR::Core::Ticks::Instruction::Out +                     // Set timer counter from register
+      0;
+
+  // constexpr unsigned adjustSyncTicks = ticksFromOverflowToISRSample + 1;
+  // constexpr unsigned adjustInitialTicks = adjustSyncTicks + 10;
+  static constexpr unsigned adjustInitialTicks =
+      ticksInitialSpinLoop / 2 +              // Half of the normal loop time
+      ticksFromTransitionToInitialTimerSync + // Initial sync
+      ticksFromOverflowToISRSample +          // Compensate for ISR service time
+      FudgeInitialTicks +                     // Let us easily fudge the numbers
+      0;
+
+  static constexpr unsigned adjustSyncTicks = ticksSpinLoop / 2 +              // Half of the loop time
+                                              ticksFromTransitionToTimerSync + // Continuous sync
+                                              ticksFromOverflowToISRSample +   // Compensate for ISR service time
+                                              FudgeSyncTicks +                 // Let us easily fudge the numbers
+                                              0;
+
+  /**
+   * Number of ticks from sampling the pin in the ISR until we're back in the spin loop, watching for transitions.
+   *
+   * @see ReadBitISR() and bitByBit()
+   */
+  static constexpr unsigned ticksFromISRSampleToSpinLoop =
+      2 +                                     // sbic + sec, or skip
+      AVR::Core::Ticks::Instruction::RJmp +   // To bitByBit()
+      3 +                                     // rol x3
+      AVR::Core::Ticks::Instruction::Branch + // brcc to reti
+      AVR::Core::Ticks::Instruction::RetI +   // Back to spin loop
+      0;
+
+  /**
+   * Choose when in each bit we sample, in ticks after the transition that started it.
+   *
+   * Ideally, the middle of the bit. But we can't sample sooner than we can set the timer after seeing a transition,
+   * and the ISR needs to be over before the next transition or we'll see it late.
+   *
+   * This is what limits which Speeds work at which F_CPU. With the default configuration, bits need to be ~30 ticks:
+   *
+   *           8 MHz 12 MHz 16 MHz 20 MHz
+   * DSHOT150  yes   yes    yes    yes
+   * DSHOT300  no    yes    yes    yes
+   * DSHOT600  no    no     no     no
+   */
+  static constexpr unsigned P = PeriodTicks;
+
+  static constexpr unsigned sampleTicksEarliest = adjustSyncTicks + 1;
+  static constexpr unsigned sampleTicksLatest = P - ticksFromISRSampleToSpinLoop;
+
+  static_assert(P > ticksFromISRSampleToSpinLoop && sampleTicksEarliest <= sampleTicksLatest,
+                "Response bits are too short to resync and sample in time at this F_CPU. Use a slower Speed.");
+
+  static constexpr unsigned sampleTicks = Const::clamp(P - HalfPeriodTicks, // The middle, rounded up
+                                                       sampleTicksEarliest, sampleTicksLatest);
+
+  static_assert(sampleTicks * 4 >= P && sampleTicks * 4 <= P * 3,
+                "Response bits would be sampled too far from the middle to tolerate clock drift at this F_CPU");
+
+  // From setting the counter at the start bit, skip it and sample the first bit
+  static constexpr unsigned ticksToFirstSample = P + sampleTicks - adjustInitialTicks;
+
+  static_assert(ticksToFirstSample >= 1 && ticksToFirstSample <= 0x100, "Can't time the first sample with Timer0");
+
+  // May wrap. The counter then counts past TOP to 0xff and around again, which is just a longer first period.
+  static constexpr u1 timerCounterValueInitial = u1(P - ticksToFirstSample);
+  // Always <= TOP since sampleTicks > adjustSyncTicks
+  static constexpr u1 timerCounterValueSync = u1(P - sampleTicks + adjustSyncTicks);
+
+  // Assumptions of these implementations
+  static_assert(P <= 0x100, "Response bits are too long for Timer0 at this F_CPU. Use a faster Speed.");
+};
+
+} // namespace DShot
+} // namespace AVR
@@ -0,0 +1,122 @@
+#pragma once
+
+/**
+ * @brief Measuring how long each ESC takes to start responding, and waiting only that long
+ * @file BDShotTurnaround.hpp
+ * @author Cameron Tacklind <cameron@tacklind.com>
+ *
+ * `getResponse()` already runs Timer0 while it waits for the start bit. When something needs the turnaround, it reads
+ * the counter right before it resyncs it, at the cost of a cycle that `ReceiveTiming` accounts for, and saves the raw
+ * timer state. That's turned into a time after the response is decoded, when it doesn't cost anything.
+ *
+ * `AdaptiveTimeout` then waits for each ESC's start bit only a little longer than that ESC's slowest recent
+ * turnaround, instead of the whole `BDShotConfig::responseTimeout`. After `fallbackMisses` timeouts in a row, it goes
+ * back to waiting the whole time until the ESC responds again.
+ *
+ * Like LinkQuality, each piece is an empty class with no storage when disabled.
+ */
+
+#include "BDShotConfig.hpp"
+#include "BDShotResponse.hpp"
+#include "basicTypes.hpp"
+
+namespace AVR {
+namespace DShot {
+using namespace Basic;
+
+/**
+ * @brief Timer state saved by the receiver at the start bit
+ */
+struct TurnaroundCapture {
+  u1 counter;
+  u1 overflowsLeft;
+  u1 flags;
+};
+
+/**
+ * @tparam ESC Anything unique to the ESC
+ */
+template <typename ESC, bool Enabled = BDShotConfig::captureTurnaround>
+class TurnaroundStash {
+  static TurnaroundCapture capture;
+
+public:
+  static constexpr bool enabled = true;
+
+  inline static void save(u1 counter, u1 overflowsLeft, u1 flags) { capture = {counter, overflowsLeft, flags}; }
+  inline static TurnaroundCapture const &get() { return capture; }
+};
+
+template <typename ESC>
+class TurnaroundStash<ESC, false> {
+public:
+  static constexpr bool enabled = false;
+
+  inline static void save(u1, u1, u1) {}
+  inline static TurnaroundCapture get() { return {}; }
+};
+
+template <typename ESC, bool Enabled>
+TurnaroundCapture TurnaroundStash<ESC, Enabled>::capture;
+
+/**
+ * @tparam ESC Anything unique to the ESC, so each one learns its own timeout
+ * @tparam ConservativeTicks The longest we ever wait. `BDShotConfig::responseTimeout` in CPU cycles.
+ * @tparam MarginTicks Added to the slowest recent turnaround
+ */
+template <typename ESC, u2 ConservativeTicks, u2 MarginTicks, bool Enabled = BDShotConfig::AdaptiveTimeout::enabled>
+class AdaptiveTimeout {
+  static u2 timeout;
+  static u2 slowest;
+  static u1 misses;
+
+public:
+  static constexpr bool enabled = true;
+
+  /**
+   * @return How long to wait for the next start bit, in CPU cycles
+   */
+  inline static u2 getTicks() { return timeout; }
+
+  /**
+   * @param r The Response we just got, with the timeout from `getTicks()`
+   * @param turnaroundTicks From the end of the command to the start bit. Ignored for timeouts.
+   */
+  static void record(Response r, u2 turnaroundTicks) {
+    if (r.getError() == Response::Error::ResponseTimeout) {
+      using BDShotConfig::AdaptiveTimeout::fallbackMisses;
+      if (misses < fallbackMisses && ++misses == fallbackMisses) timeout = ConservativeTicks;
+      return;
+    }
+
+    misses = 0;
+
+    // Follow the slowest turnaround right away, but forget it slowly
+    slowest -= slowest >> 4;
+    if (turnaroundTicks > slowest) slowest = turnaroundTicks;
+
+    u2 const next = slowest + (slowest >> 3) + MarginTicks;
+    timeout = next < ConservativeTicks ? next : ConservativeTicks;
+  }
+};
+
+template <typename ESC, u2 ConservativeTicks, u2 MarginTicks>
+class AdaptiveTimeout<ESC, ConservativeTicks, MarginTicks, false> {
+public:
+  static constexpr bool enabled = false;
+
+  inline static constexpr u2 getTicks() { return ConservativeTicks; }
+  inline static void record(Response, u2) {}
+};
+
+template <typename ESC, u2 ConservativeTicks, u2 MarginTicks, bool Enabled>
+u2 AdaptiveTimeout<ESC, ConservativeTicks, MarginTicks, Enabled>::timeout = ConservativeTicks;
+
+template <typename ESC, u2 ConservativeTicks, u2 MarginTicks, bool Enabled>
+u2 AdaptiveTimeout<ESC, ConservativeTicks, MarginTicks, Enabled>::slowest;
+
+template <typename ESC, u2 ConservativeTicks, u2 MarginTicks, bool Enabled>
+u1 AdaptiveTimeout<ESC, ConservativeTicks, MarginTicks, Enabled>::misses;
+
+} // namespace DShot
+} // namespace AVR
@@ -1,5 +1,7 @@
 #pragma once
 
+#include "CoreTicks.hpp"
+
 namespace AVR {
 namespace Core {
 
@@ -26,21 +28,5 @@ inline static void setZ(T (*z)()) {
   setZ((void *)z);
 }
 
-namespace Ticks {
-namespace Hardware {
-constexpr unsigned ISR = 5;
-} // namespace Hardware
-namespace Instruction {
-constexpr unsigned Skip1Word = 2;
-constexpr unsigned Skip2Words = 3;
-constexpr unsigned LoaDImediate = 1;
-constexpr unsigned Out = 1;
-constexpr unsigned Branch = 2;
-constexpr unsigned Jmp = 3;
-constexpr unsigned IJmp = 2;
-constexpr unsigned RJmp = 2;
-constexpr unsigned RetI = 5; // Or is it 4?
-} // namespace Instruction
-} // namespace Ticks
 } // namespace Core
 } // namespace AVR
\ No newline at end of file
@@ -0,0 +1,30 @@
+#pragma once
+
+/*
+ * File:   CoreTicks.hpp
+ * Author: Cameron Tacklind
+ *
+ * How many clock cycles the core takes for things. Kept apart from Core.hpp so host side tools can use them too.
+ */
+
+namespace AVR {
+namespace Core {
+
+namespace Ticks {
+namespace Hardware {
+constexpr unsigned ISR = 5;
+} // namespace Hardware
+namespace Instruction {
+constexpr unsigned Skip1Word = 2;
+constexpr unsigned Skip2Words = 3;
+constexpr unsigned LoaDImediate = 1;
+constexpr unsigned Out = 1;
+constexpr unsigned Branch = 2;
+constexpr unsigned Jmp = 3;
+constexpr unsigned IJmp = 2;
+constexpr unsigned RJmp = 2;
+constexpr unsigned RetI = 5; // Or is it 4?
+} // namespace Instruction
+} // namespace Ticks
+} // namespace Core
+} // namespace AVR
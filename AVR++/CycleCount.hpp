@@ -0,0 +1,58 @@
+#pragma once
+
+/**
+ * @brief Measure how many CPU cycles some code takes, on the chip
+ * @file CycleCount.hpp
+ *
+ * Uses Timer1 with no prescaler. Timer1 is taken over while measuring and left stopped.
+ *
+ * Interrupts should be disabled by the caller if they would skew the results.
+ * Measurements are limited to 65535 cycles.
+ *
+ * Usage:
+ *
+ * ```C++
+ * #include <AVR++/CycleCount.hpp>
+ *
+ * u2 cycles = AVR::CycleCount::measure([] { doSomething(); });
+ * ```
+ */
+
+#include "basicTypes.hpp"
+#include "undefAVR.hpp"
+#include <avr/io.h>
+
+namespace AVR {
+using namespace Basic;
+
+class CycleCount {
+  inline static void start() { TCCR1B = 1 << CS10; }
+  inline static void stop() { TCCR1B = 0; }
+
+public:
+  /**
+   * @brief Cycles from starting the timer to stopping it, including the cost of starting and stopping
+   */
+  template <typename F>
+  inline static u2 raw(F f) {
+    TCCR1A = 0;
+    stop();
+    TCNT1 = 0;
+
+    start();
+    f();
+    stop();
+
+    return TCNT1;
+  }
+
+  /**
+   * @brief Cycles spent in `f`, with the cost of measuring removed
+   */
+  template <typename F>
+  inline static u2 measure(F f) {
+    return raw(f) - raw([] {});
+  }
+};
+
+} // namespace AVR
@@ -97,6 +97,31 @@ constexpr unsigned pulseNanos0(Speeds speed) {
   return 0;
 }
 
+/**
+ * A bit, start to start, is 8/3 of the "0" high time
+ */
+constexpr double bitNanos(Speeds speed) { return pulseNanos0(speed) * 8 / 3.0; }
+
+/**
+ * How much longer than `bitNanos()` the bits we send may be
+ */
+constexpr double BitTolerance = 0.25;
+
+template <Ports Port, int Pin, Speeds Speed, bool Inverted, bool Balanced>
+using DShotPulses =
+    PulsedOutput<Port, Pin, pulseNanos0(Speed), Inverted, Balanced, false, false, pulseNanos0(Speed) * 2 / 3>;
+
+/**
+ * Balanced bits are all the same length, but need room in the low time to load the next byte. At fast speeds, that
+ * makes every bit longer than the protocol's. Those are sent unbalanced instead, as short as they can be, with a
+ * longer low time after each byte. Even then, the last bit of a byte may not fit, like DSHOT600 and DSHOT1200 at 16MHz.
+ */
+template <Ports Port, int Pin, Speeds Speed, bool Inverted>
+constexpr bool balanceBits() {
+  return DShotPulses<Port, Pin, Speed, Inverted, true>::PulseMath::realBitNanosecondsMax <=
+         bitNanos(Speed) * (1 + BitTolerance);
+}
+
 enum class SpecialCommand : u1 {
   // Commands 0-36 are only executed when motors are stopped.
 
@@ -228,9 +253,11 @@ static_assert(c.bytes == &c.commandHigh, "CommandHigh should be first byte");
 } // namespace SelfTest
 
 template <Ports Port, int Pin, Speeds Speed = NominalSpeed, bool Inverted = false>
-class DShot
-    : protected PulsedOutput<Port, Pin, pulseNanos0(Speed), Inverted, true, false, false, pulseNanos0(Speed) * 2 / 3> {
-  using Parent = PulsedOutput<Port, Pin, pulseNanos0(Speed), Inverted, true, false, false, pulseNanos0(Speed) * 2 / 3>;
+class DShot : protected DShotPulses<Port, Pin, Speed, Inverted, balanceBits<Port, Pin, Speed, Inverted>()> {
+  using Parent = DShotPulses<Port, Pin, Speed, Inverted, balanceBits<Port, Pin, Speed, Inverted>()>;
+
+  static_assert(Parent::PulseMath::realBitNanosecondsMax <= bitNanos(Speed) * (1 + BitTolerance),
+                "DShot bits would be too long. Use a slower Speed or a faster F_CPU.");
 
 protected:
   using Parent::input;
@@ -0,0 +1,103 @@
+#pragma once
+
+/**
+ * @file DShotAsync.cpp
+ * @author Cameron Tacklind <cameron@tacklind.com>
+ * @brief The implementation of the DShotAsync class
+ * @note This file is part of the AVR++ library.
+ */
+
+#include "DShotAsync.hpp"
+
+// Yes, we're including the cpp
+#include "DShot.cpp"
+
+template <AVR::Ports Port, int Pin, AVR::DShot::Speeds Speed, bool Inverted>
+volatile Basic::u2 AVR::DShot::DShotAsync<Port, Pin, Speed, Inverted>::frame;
+
+template <AVR::Ports Port, int Pin, AVR::DShot::Speeds Speed, bool Inverted>
+volatile Basic::u1 AVR::DShot::DShotAsync<Port, Pin, Speed, Inverted>::bitsLeft;
+
+template <AVR::Ports Port, int Pin, AVR::DShot::Speeds Speed, bool Inverted>
+volatile bool AVR::DShot::DShotAsync<Port, Pin, Speed, Inverted>::sending;
+
+template <AVR::Ports Port, int Pin, AVR::DShot::Speeds Speed, bool Inverted>
+typename AVR::DShot::DShotAsync<Port, Pin, Speed, Inverted>::Handler
+    AVR::DShot::DShotAsync<Port, Pin, Speed, Inverted>::handler;
+
+template <AVR::Ports Port, int Pin, AVR::DShot::Speeds Speed, bool Inverted>
+void AVR::DShot::DShotAsync<Port, Pin, Speed, Inverted>::sendCommandAsync(Frame c, Handler done) {
+  while (sending)
+    ;
+
+  asm("; DShotAsync::sendCommandAsync");
+
+  // Stop the timer, in Normal mode
+  Timer::interruptMask() = 0;
+  Timer::controlB() = 0;
+
+  // Force the compare latch to idle before it's connected to the pin
+  Timer::controlA() = CompareOutputMode << Timer::CompareOutputModeShift;
+  Timer::controlC() = Timer::ForceOutputCompare;
+
+  // Set the mode while still stopped
+  Timer::controlB() = Timer::WGMB(FastPWM);
+  Timer::controlA() = CompareOutputMode << Timer::CompareOutputModeShift | Timer::WGMA(FastPWM);
+
+  Timer::inputCapture() = AsyncMath::top;
+
+  u2 bits = u2(c.bytes[0]) << 8 | c.bytes[1];
+
+  // Buffered until TOP, which is the next tick
+  Timer::compare() = width(bits & 0x8000);
+
+  frame = bits << 1;
+  bitsLeft = sizeof(c.bytes) * 8 - 1;
+  handler = done;
+  sending = true;
+
+  Timer::counter() = AsyncMath::top - 1;
+
+  Timer::interruptFlags() = Timer::Overflow | Timer::CompareMatch;
+  Timer::interruptMask() = Timer::Overflow;
+
+  // No prescaler. Go!
+  Timer::controlB() = Timer::WGMB(FastPWM) | Timer::NoPrescaler;
+}
+
+template <AVR::Ports Port, int Pin, AVR::DShot::Speeds Speed, bool Inverted>
+void AVR::DShot::DShotAsync<Port, Pin, Speed, Inverted>::stop() {
+  Timer::interruptMask() = 0;
+  Timer::controlB() = 0;
+
+  // Disconnect the pin. The Port is already at idle.
+  Timer::controlA() = 0;
+
+  sending = false;
+
+  if (handler) handler();
+}
+
+template <AVR::Ports Port, int Pin, AVR::DShot::Speeds Speed, bool Inverted>
+void AVR::DShot::DShotAsync<Port, Pin, Speed, Inverted>::interrupt() {
+  // A new bit just started. Load the width of the next one.
+  if (Timer::interruptMask() & Timer::Overflow) {
+    if (u1 const n = bitsLeft) {
+      u2 const bits = frame;
+      Timer::compare() = width(bits & 0x8000);
+      frame = bits << 1;
+      bitsLeft = n - 1;
+      return;
+    }
+
+    // The last bit just started. Make sure another one never does and wait for it to be over.
+    Timer::inputCapture() = 0xffff;
+    Timer::interruptFlags() = Timer::CompareMatch;
+    Timer::interruptMask() = Timer::CompareMatch;
+
+    // Were we late enough to miss it?
+    if (Timer::counter() < Timer::compare()) return;
+  }
+
+  stop();
+}
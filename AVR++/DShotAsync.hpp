@@ -0,0 +1,171 @@
+#pragma once
+
+/**
+ * @brief Non-blocking DShot implementation for AVRs using Output Compare hardware
+ * @file DShotAsync.hpp
+ * @author Cameron Tacklind <cameron@tacklind.com>
+ *
+ * `DShot` bit-bangs every frame with interrupts disabled. This implementation lets a 16-bit timer generate the pulses
+ * instead so `sendCommandAsync()` returns right away and the CPU is free while the frame goes out.
+ *
+ * The timer runs in Fast PWM mode with TOP in ICRn, one timer period per bit. The hardware asserts the pin at BOTTOM
+ * and releases it when the counter matches OCRn. OCRn is double buffered, so the overflow interrupt at the start of
+ * each bit has a whole bit period to load the pulse width of the next one. Other interrupts only need to be shorter
+ * than a bit, minus our own interrupt, for the frame to go out correctly.
+ *
+ * After the last bit starts, TOP is raised so no more bits are started and the compare interrupt shuts everything
+ * down once the last pulse is over.
+ *
+ * Only pins connected to a 16-bit timer's Output Compare unit can be used (see OutputCompare.hpp). On the ATmega32U4,
+ * that is PB5, PB6, PB7 (Timer1) and PC6 (Timer3). Timer1 is also used by `BDShotCapture` and `CycleCount`, so prefer
+ * PC6 when using either of those.
+ *
+ * The timer's interrupt vectors are left to the user, like `ScanningADC`, since they depend on the pin.
+ *
+ * Simplified API:
+ *
+ * template <Ports Port, int Pin, AVR::DShot::Speeds Speed = [150/300], bool Inverted = false>
+ * class AVR::DShot::DShotAsync {
+ *   static void init();
+ *   static void sendCommand(Command);
+ *   static void sendCommandAsync(Command, Handler done = nullptr);
+ *   static bool isSending();
+ *   static void interrupt(); // Call from the timer's overflow and compare ISRs
+ * }
+ *
+ * Usage:
+ *
+ * ```main.cpp
+ * #include <AVR++/DShotAsync.cpp> // Yes, a cpp file
+ *
+ * using ESC = AVR::DShot::DShotAsync<Ports::C, 6>;
+ *
+ * template class AVR::DShot::DShotAsync<Ports::C, 6>;
+ *
+ * ISR(TIMER3_OVF_vect) { ESC::interrupt(); }
+ * ISR(TIMER3_COMPA_vect, ISR_ALIASOF(TIMER3_OVF_vect));
+ *
+ * int main() {
+ *   ESC::init();
+ *   sei();
+ *
+ *   while (true) {
+ *     ESC::sendCommandAsync(0.5);
+ *
+ *     // Do other things while the frame is sent
+ *
+ *     while (ESC::isSending());
+ *   }
+ * }
+ * ```
+ *
+ * @see DShot.hpp for `Command`
+ */
+
+#include "DShot.hpp"
+#include "OutputCompare.hpp"
+
+namespace AVR {
+namespace DShot {
+using namespace AVR;
+using namespace Basic;
+
+template <Ports Port, int Pin, Speeds Speed = NominalSpeed, bool Inverted = false>
+class DShotAsync : protected DShot<Port, Pin, Speed, Inverted> {
+  using Parent = DShot<Port, Pin, Speed, Inverted>;
+  using Timer = OutputCompare<Port, Pin>;
+
+  static_assert(Timer::exists, "Pin is not connected to the Output Compare unit of a 16-bit timer");
+
+public:
+  /**
+   * A function that will be called when the frame is done sending.
+   *
+   * Executed in interrupt context.
+   */
+  typedef void (*Handler)();
+
+protected:
+  using Frame = Command<Inverted>;
+
+  struct AsyncMath {
+    static constexpr unsigned ticksBit = Const::round(F_CPU * (pulseNanos0(Speed) * 8 / 3 / 1e9));
+    static constexpr unsigned ticksShort = Parent::PulseMath::cyclesShort;
+    static constexpr unsigned ticksLong = Parent::PulseMath::cyclesLong;
+
+    /**
+     * Our interrupt needs to be able to load the next width before the current bit is over.
+     * Entering an interrupt, saving registers, and getting to the OCRn write takes about this long.
+     */
+    static constexpr unsigned minTicksBit = 40;
+
+    static_assert(ticksBit >= minTicksBit, "Bits are too short to be loaded by an interrupt at this F_CPU");
+    static_assert(ticksBit <= 0x10000, "Bits are too long for a 16-bit timer at this F_CPU");
+
+    static constexpr u2 top = ticksBit - 1;
+  };
+
+  /**
+   * Compare Output Mode that releases the pin on compare match and asserts it at BOTTOM. In Normal mode, the same bits
+   * just release the pin on compare match, which we use to force the idle level before connecting the pin.
+   */
+  static constexpr u1 CompareOutputMode = Inverted ? 0b11 : 0b10;
+
+  // Fast PWM, TOP = ICRn
+  static constexpr u1 FastPWM = 14;
+
+  /**
+   * The rest of the frame, MSB first
+   */
+  static volatile u2 frame;
+
+  /**
+   * Bits in `frame` that still need to be loaded
+   */
+  static volatile u1 bitsLeft;
+
+  static volatile bool sending;
+
+  static Handler handler;
+
+  /**
+   * The compare value for a bit. Fast PWM holds the pin from BOTTOM through the match, which is OCRn + 1 ticks.
+   */
+  inline static u2 width(bool one) { return one ? AsyncMath::ticksLong - 1 : AsyncMath::ticksShort - 1; }
+
+  static void stop();
+
+public:
+  // Exposed for development/debugging
+  using Parent::PulseMath;
+
+  using Parent::init;
+  using Parent::sendCommand;
+
+  /**
+   * @brief Start sending a Command and return right away
+   *
+   * Waits for the previous Command, if any, to finish first. Global interrupts must be enabled.
+   *
+   * @param c The Command to send
+   * @param done Optional function to call from interrupt context once the frame is done
+   */
+  static void sendCommandAsync(Frame c, Handler done = nullptr);
+
+  /**
+   * @return true while a Command is still being sent
+   */
+  inline static bool isSending() { return sending; }
+
+  /**
+   * Call this from both the timer's overflow and compare ISRs. Something like:
+   * ```C++
+   * ISR(TIMER3_OVF_vect) { ESC::interrupt(); }
+   * ISR(TIMER3_COMPA_vect, ISR_ALIASOF(TIMER3_OVF_vect));
+   * ```
+   */
+  static void interrupt();
+};
+
+} // namespace DShot
+} // namespace AVR
@@ -0,0 +1,243 @@
+#pragma once
+
+/**
+ * @brief Send frames to several DShot/BDShot motors at a fixed rate
+ * @file DShotScheduler.hpp
+ * @author Cameron Tacklind <cameron@tacklind.com>
+ *
+ * A 16-bit timer ticks at the frame rate, in CTC mode. `sendFrames()` waits for the next tick and then sends every
+ * motor its Command back to back, so frames start at a fixed rate no matter how long the rest of the control loop
+ * takes, as long as it's shorter than a period.
+ *
+ * The tick is polled, not an interrupt, so nothing else changes about how `DShot` and `BDShot` need interrupts set up.
+ *
+ * Measured for every tick:
+ * - How late the frames started, in timer ticks. Mostly how long the polling loop takes to notice the tick.
+ * - Overruns, when the previous call returned after the next tick had already happened. The frames go right away.
+ *
+ * The timer only flags that at least one tick happened, so an overrun of several periods still counts as one.
+ * Lateness isn't known then either, since the count is from the last tick, not the first one missed. Overruns leave
+ * the lateness stats alone, so they only cover frames that started on time.
+ *
+ * Rates the motors can't keep up with fail to compile. Each motor's frame time comes from its `PulseMath`, and
+ * `BDShot` motors also wait for their response.
+ *
+ * Simplified API:
+ *
+ * template <typename Timer, unsigned RateHz, typename... Motors>
+ * class AVR::DShot::FrameScheduler {
+ *   static constexpr u1 Count; // sizeof...(Motors)
+ *   static void start();
+ *   static void sendFrames(T const (&commands)[Count], Response (&responses)[Count]);
+ *   static void sendFrames(T const (&commands)[Count]);
+ *   static Stats getStats();
+ *   static void resetStats();
+ * }
+ *
+ * Usage:
+ *
+ * ```main.cpp
+ * #include <AVR++/BDShot.cpp> // Yes, a cpp file
+ * #include <AVR++/DShotScheduler.hpp>
+ *
+ * using Front = AVR::DShot::BDShot<Ports::B, 0>;
+ * using Back = AVR::DShot::BDShot<Ports::B, 1>;
+ *
+ * template class AVR::DShot::BDShot<Ports::B, 0>;
+ * template class AVR::DShot::BDShot<Ports::B, 1>;
+ *
+ * using Motors = AVR::DShot::FrameScheduler<AVR::Timers::Timer1, 2000, Front, Back>;
+ *
+ * int main() {
+ *   Front::init();
+ *   Back::init();
+ *   Motors::start();
+ *   sei();
+ *
+ *   AVR::DShot::Response responses[Motors::Count];
+ *
+ *   while (true) {
+ *     float throttle[Motors::Count] = {0.1, 0.2};
+ *     Motors::sendFrames(throttle, responses);
+ *     // Control loop. Less than 500us, minus the frames.
+ *   }
+ * }
+ * ```
+ *
+ * The timer is taken over. `AVR::Timers::Timer1` is also used by `BDShotCapture` and `CycleCount`.
+ */
+
+#include "BDShot.hpp"
+#include "OutputCompare.hpp"
+
+namespace AVR {
+namespace DShot {
+using namespace Basic;
+
+/**
+ * @brief Worst case CPU cycles to send one frame, from the motor's `PulseMath`
+ */
+template <typename Motor>
+struct FrameCycles {
+  using PM = typename Motor::PulseMath;
+
+  // Every bit a "1", plus the outer loop for each byte, plus calling and turning interrupts off and on
+  static constexpr unsigned value =
+      16 * (PM::realHighCyclesLong + PM::realLowCyclesMin) + 2 * PM::outerLoopExtraCycles + 20;
+};
+
+/**
+ * BDShot also waits for the response and decodes it
+ */
+template <Ports Port, int Pin, Speeds Speed>
+struct FrameCycles<BDShot<Port, Pin, Speed>> {
+  using PM = typename BDShot<Port, Pin, Speed>::PulseMath;
+
+  static constexpr unsigned value =
+      16 * (PM::realHighCyclesLong + PM::realLowCyclesMin) + 2 * PM::outerLoopExtraCycles + // Command
+      Const::round(F_CPU * (BDShotConfig::responseTimeout / 1e6)) +                          // Worst case turnaround
+      Const::round(F_CPU * (21 * responseBitNanos(Speed) / 1e9)) +                           // Response
+      200;                                                                                   // Decode, and margin
+};
+
+/**
+ * @brief How to send one motor its Command
+ */
+template <typename Motor>
+struct SendFrame {
+  template <typename T>
+  inline static void to(T const &command, Response &) {
+    Motor::sendCommand(command);
+  }
+};
+
+template <Ports Port, int Pin, Speeds Speed>
+struct SendFrame<BDShot<Port, Pin, Speed>> {
+  template <typename T>
+  inline static void to(T const &command, Response &response) {
+    response = BDShot<Port, Pin, Speed>::sendCommand(command);
+  }
+};
+
+/**
+ * @tparam Timer A 16-bit timer, like `AVR::Timers::Timer1`
+ * @tparam RateHz Frames per second, for every motor
+ * @tparam Motors `DShot` or `BDShot` instances, in the order frames are sent
+ */
+template <typename Timer, unsigned RateHz, typename... Motors>
+class FrameScheduler {
+public:
+  static constexpr u1 Count = sizeof...(Motors);
+
+  struct Stats {
+    u2 frames;
+    // Calls that came after the tick. Not periods missed: several in a row count as one.
+    u2 overruns;
+    // Timer ticks from the tick to starting the frames, when not an overrun. See `TickMath::nanosPerTick`.
+    u2 lastLateTicks;
+    u2 maxLateTicks;
+  };
+
+protected:
+  static constexpr unsigned sum() { return 0; }
+  template <typename... T>
+  static constexpr unsigned sum(unsigned first, T... rest) {
+    return first + sum(rest...);
+  }
+
+public:
+  struct TickMath {
+    static constexpr u4 cyclesPerFrame = F_CPU / RateHz;
+    static constexpr unsigned cyclesAllMotors = sum(FrameCycles<Motors>::value...);
+
+    static_assert(RateHz, "RateHz must not be 0");
+    static_assert(Count, "Need at least one motor");
+    static_assert(cyclesAllMotors < cyclesPerFrame,
+                  "These motors' frames don't all fit in one period at this rate. Use a lower rate or faster Speed.");
+
+    // Clock Select bits in TCCRnB, and the matching prescaler. Smallest that fits in 16 bits.
+    static constexpr u1 clockSelect = cyclesPerFrame <= 0x10000 ? 0b001 : cyclesPerFrame / 8 <= 0x10000 ? 0b010 : 0b011;
+    static constexpr u1 prescaler = clockSelect == 0b001 ? 1 : clockSelect == 0b010 ? 8 : 64;
+
+    static_assert(cyclesPerFrame / prescaler <= 0x10000, "RateHz is too slow for a 16-bit timer at this F_CPU");
+
+    static constexpr u2 top = cyclesPerFrame / prescaler - 1;
+
+    static constexpr double nanosPerTick = prescaler * 1e9 / F_CPU;
+  };
+
+protected:
+  // CTC, TOP = OCRnA
+  static constexpr u1 CTC = 4;
+
+  static Stats stats;
+
+  inline static bool ticked() { return Timer::interruptFlags() & Timer::CompareMatch; }
+
+  inline static void waitForTick() {
+    stats.frames++;
+
+    if (ticked()) {
+      // How many periods ago, and so how late, can't be told. Just go.
+      Timer::interruptFlags() = Timer::CompareMatch;
+      stats.overruns++;
+      return;
+    }
+
+    while (!ticked())
+      ;
+
+    u2 const late = Timer::counter();
+    Timer::interruptFlags() = Timer::CompareMatch;
+
+    stats.lastLateTicks = late;
+    if (late > stats.maxLateTicks) stats.maxLateTicks = late;
+  }
+
+public:
+  /**
+   * @brief Take over the timer and start ticking. The first tick is one period from now.
+   */
+  static void start() {
+    Timer::interruptMask() = 0;
+    Timer::controlB() = 0;
+    Timer::controlA() = Timer::WGMA(CTC);
+    Timer::compare() = TickMath::top;
+    Timer::counter() = 0;
+    Timer::interruptFlags() = Timer::CompareMatch;
+    Timer::controlB() = Timer::WGMB(CTC) | TickMath::clockSelect;
+  }
+
+  /**
+   * @brief Wait for the next tick and send every motor its Command
+   *
+   * @param commands Anything Command can be made from, one per motor
+   * @param responses Filled for `BDShot` motors. Left alone for `DShot` motors.
+   */
+  template <typename T>
+  static void sendFrames(T const (&commands)[Count], Response (&responses)[Count]) {
+    waitForTick();
+
+    u1 i = 0;
+    using expand = int[];
+    (void)expand{0, (SendFrame<Motors>::to(commands[i], responses[i]), i++, 0)...};
+  }
+
+  template <typename T>
+  inline static void sendFrames(T const (&commands)[Count]) {
+    Response ignored[Count];
+    sendFrames(commands, ignored);
+  }
+
+  /**
+   * Counters wrap. Take differences between snapshots.
+   */
+  inline static Stats getStats() { return stats; }
+  inline static void resetStats() { stats = {}; }
+};
+
+template <typename Timer, unsigned RateHz, typename... Motors>
+typename FrameScheduler<Timer, RateHz, Motors...>::Stats FrameScheduler<Timer, RateHz, Motors...>::stats;
+
+} // namespace DShot
+} // namespace AVR
@@ -0,0 +1,66 @@
+#pragma once
+
+/**
+ * @brief Read bytes from flash one after another, with post-increment `lpm`/`elpm`
+ * @file FlashReader.hpp
+ *
+ * `FlashArray` is for data at a fixed address. These are for streaming through data whose address is only known at
+ * run time, like frames of an animation. Each read is one `lpm Z+` (3 cycles), instead of `pgm_read_byte()` and
+ * incrementing the address separately.
+ *
+ * They are also load functions for `PulsedOutput::send(data, bytes, load)`, which ignore the RAM pointer it passes.
+ *
+ * Flash past 64KB needs `FarFlashReader` and a chip with `elpm`. Get addresses with `pgm_get_far_address()`.
+ */
+
+#include "basicTypes.hpp"
+#include <avr/io.h>
+
+namespace AVR {
+using namespace Basic;
+
+class FlashReader {
+  u1 const *address;
+
+public:
+  /**
+   * @param address In flash (`PROGMEM`), below 64KB
+   */
+  inline FlashReader(void const *address) : address((u1 const *)address) {}
+
+  inline u1 next() {
+    u1 b;
+    asm volatile("lpm %0, Z+" : "=r"(b), "+z"(address));
+    return b;
+  }
+
+  inline u1 operator()(u1 const *) { return next(); }
+};
+
+#ifdef __AVR_HAVE_ELPM__
+/**
+ * `elpm Z+` increments all of RAMPZ:Z, so crossing 64KB boundaries just works. RAMPZ is set when this is made and left
+ * however far it got. Call `done()` to put it back to 0 if other code expects that.
+ */
+class FarFlashReader {
+  u2 z;
+
+public:
+  /**
+   * @param address From `pgm_get_far_address()`
+   */
+  inline FarFlashReader(u4 address) : z(address) { RAMPZ = address >> 16; }
+
+  inline u1 next() {
+    u1 b;
+    asm volatile("elpm %0, Z+" : "=r"(b), "+z"(z));
+    return b;
+  }
+
+  inline u1 operator()(u1 const *) { return next(); }
+
+  inline static void done() { RAMPZ = 0; }
+};
+#endif
+
+}; // namespace AVR
@@ -1,6 +1,7 @@
 #pragma once
 
 #include "basicTypes.hpp"
+#include "ProgramSpace.hpp"
 
 namespace GCR {
 constexpr static unsigned inBits = 5;
@@ -13,6 +14,8 @@ constexpr static unsigned outCeiling = 1 << outBits;
 constexpr static unsigned outMax = outCeiling - 1;
 constexpr static unsigned outMask = outCeiling - 1;
 
+constexpr static Basic::u1 Invalid = 0xff;
+
 inline static constexpr Basic::u1 decode(Basic::u1 const gcr) {
   // clang-format off
   switch (gcr) {
@@ -32,9 +35,86 @@ inline static constexpr Basic::u1 decode(Basic::u1 const gcr) {
     case 0b01101: return 0b1101; // gcr & 0b1111
     case 0b01110: return 0b1110; // gcr & 0b1111
     case 0b01111: return 0b1111; // gcr & 0b1111
-    default: return 0xff;
+    default: return Invalid;
   }
   // clang-format on
 }
 
-} // namespace GCR
\ No newline at end of file
+/**
+ * @brief The different ways we know how to decode a quintet
+ *
+ * Switch: Smallest. Compiles to a jump table or compare chain. Best called with `rcall` to share it.
+ * TableRAM: Fastest. Costs 32 bytes of RAM.
+ * TableFlash: Almost as fast. `lpm` takes one more cycle than `ld`.
+ *
+ * @see GCRBenchmark.hpp to measure them on your build
+ */
+enum class Decoder {
+  Switch,
+  TableRAM,
+  TableFlash,
+};
+
+/**
+ * @brief All 32 possible quintets, decoded. `Invalid` for codes that aren't used.
+ */
+struct Table {
+  Basic::u1 values[inCeiling];
+
+  constexpr Table() : values{} {
+    for (Basic::u1 i = 0; i < inCeiling; i++)
+      values[i] = decode(i);
+  }
+
+  constexpr Basic::u1 operator[](Basic::u1 gcr) const { return values[gcr]; }
+};
+
+constexpr static Table TableRAM{};
+constexpr static Table TableFlash PROGMEM{};
+
+static_assert(TableRAM[0b11001] == 0b0000, "Table should match decode()");
+static_assert(TableRAM[0b01111] == 0b1111, "Table should match decode()");
+static_assert(TableRAM[0b00000] == Invalid, "Table should match decode()");
+
+/**
+ * @brief Decode a quintet with the chosen Decoder
+ *
+ * @param gcr The quintet to decode. Must already be masked with `inMask` for the table decoders.
+ */
+template <Decoder D>
+inline static Basic::u1 decodeWith(Basic::u1 const gcr) {
+  switch (D) {
+  case Decoder::Switch:
+    return decode(gcr);
+  case Decoder::TableRAM:
+    return TableRAM.values[gcr];
+  case Decoder::TableFlash:
+    return pgm_read_byte(&TableFlash.values[gcr]);
+  }
+  return Invalid;
+}
+
+/**
+ * @brief Decode 4 quintets (20 bits) into 16 bits in one pass
+ *
+ * Quintets are not checked individually. Instead, the upper bits of every lookup are collected and checked once.
+ *
+ * @param gcr 20 bits of GCR encoded data, most significant quintet first
+ * @return The 16 decoded bits, or a value with bits above the lower 16 set if any quintet was invalid.
+ * @see isInvalidWord()
+ */
+template <Decoder D = Decoder::TableRAM>
+inline static Basic::u3 decodeWord(Basic::u3 const gcr) {
+  Basic::u1 const n0 = decodeWith<D>(Basic::u1(gcr >> (inBits * 0)) & inMask);
+  Basic::u1 const n1 = decodeWith<D>(Basic::u1(gcr >> (inBits * 1)) & inMask);
+  Basic::u1 const n2 = decodeWith<D>(Basic::u1(gcr >> (inBits * 2)) & inMask);
+  Basic::u1 const n3 = decodeWith<D>(Basic::u1(gcr >> (inBits * 3)) & inMask);
+
+  Basic::u1 const invalid = (n0 | n1 | n2 | n3) & ~outMask;
+
+  return Basic::u3(invalid) << 16 | Basic::u2(Basic::u2(n3) << 12 | Basic::u2(n2) << 8) | Basic::u1(n1 << 4 | n0);
+}
+
+inline static constexpr bool isInvalidWord(Basic::u3 const word) { return word >> 16; }
+
+} // namespace GCR
@@ -0,0 +1,93 @@
+#pragma once
+
+/**
+ * @brief Compare the different GCR decoders on the chip
+ * @file GCRBenchmark.hpp
+ *
+ * Helps pick `BDShotConfig::gcrDecoder` for a particular build.
+ *
+ * Every decoder decodes all 32 possible quintets. The fused decoders do the same quintets 4 at a time.
+ * The cost of the loop itself is reported separately so it can be subtracted.
+ *
+ * The switch decoder is called with `rcall`, the same way `BDShot` uses it.
+ *
+ * Usage:
+ *
+ * ```C++
+ * #include <AVR++/GCRBenchmark.hpp>
+ *
+ * cli();
+ * auto res = GCR::Benchmark::run();
+ * sei();
+ * // Send res over USART
+ * ```
+ */
+
+#include "CycleCount.hpp"
+#include "GCR.hpp"
+
+namespace GCR {
+namespace Benchmark {
+using namespace Basic;
+
+struct Result {
+  // For 32 quintets
+  u2 loop;
+  u2 switchDecode;
+  u2 tableRAM;
+  u2 tableFlash;
+  // For 8 words of 4 quintets
+  u2 wordLoop;
+  u2 fusedRAM;
+  u2 fusedFlash;
+};
+
+namespace {
+__attribute__((noinline)) u1 decodeCall(u1 gcr) { return decode(gcr); }
+
+template <typename F>
+inline u2 quintets(F decoder) {
+  return AVR::CycleCount::measure([decoder] {
+    u1 sink = 0;
+    for (u1 i = 0; i < inCeiling; i++) {
+      u1 q = i;
+      // Don't let the compiler know what we're decoding
+      asm volatile("" : "+r"(q));
+      sink ^= decoder(q);
+    }
+    asm volatile("" ::"r"(sink));
+  });
+}
+
+template <typename F>
+inline u2 words(F decoder) {
+  return AVR::CycleCount::measure([decoder] {
+    u3 sink = 0;
+    for (u1 i = 0; i < inCeiling; i += 4) {
+      u3 w = u3(i + 3) << (inBits * 3) | u3(i + 2) << (inBits * 2) | u2(i + 1) << (inBits * 1) | i;
+      // Don't let the compiler know what we're decoding
+      asm volatile("" : "+r"(w));
+      sink ^= decoder(w);
+    }
+    asm volatile("" ::"r"(sink));
+  });
+}
+} // namespace
+
+inline Result run() {
+  Result r;
+
+  r.loop = quintets([](u1 q) { return q; });
+  r.switchDecode = quintets(decodeCall);
+  r.tableRAM = quintets(decodeWith<Decoder::TableRAM>);
+  r.tableFlash = quintets(decodeWith<Decoder::TableFlash>);
+
+  r.wordLoop = words([](u3 w) { return w; });
+  r.fusedRAM = words(decodeWord<Decoder::TableRAM>);
+  r.fusedFlash = words(decodeWord<Decoder::TableFlash>);
+
+  return r;
+}
+
+} // namespace Benchmark
+} // namespace GCR
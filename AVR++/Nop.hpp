@@ -11,6 +11,7 @@ static inline void nopCycles(unsigned cycles) {
 #ifdef __BUILTIN_AVR_DELAY_CYCLES
   asm volatile("; __builtin_avr_delay_cycles(%0)" : : "I"(cycles));
   __builtin_avr_delay_cycles(cycles);
+  asm volatile("; __builtin_avr_delay_cycles end");
 #else
   asm volatile("; nopCycles(%0)" : : "I"(cycles));
 
@@ -20,6 +21,8 @@ static inline void nopCycles(unsigned cycles) {
 
   while (cycles--)
     asm volatile("rjmp .");
+
+  asm volatile("; nopCycles end");
 #endif
 }
 } // namespace AVR
\ No newline at end of file
@@ -0,0 +1,82 @@
+#pragma once
+
+/*
+ * File:   OutputCompare.hpp
+ * Author: Cameron Tacklind
+ *
+ * Which pins can be driven by a 16-bit timer's Output Compare hardware and how to get at that timer's registers.
+ */
+
+#include "Ports.hpp"
+#include "undefAVR.hpp"
+#include <avr/io.h>
+
+namespace AVR {
+
+using namespace Basic;
+
+/**
+ * @brief Registers of one channel of a 16-bit timer. They all share the same layout.
+ *
+ * @tparam Base Address of TCCRnA
+ * @tparam MaskRegister Address of TIMSKn
+ * @tparam FlagRegister Address of TIFRn
+ * @tparam Channel 0 for A, 1 for B, 2 for C
+ */
+template <u1 Base, u1 MaskRegister, u1 FlagRegister, u1 Channel>
+struct OutputCompareChannel {
+  static constexpr bool exists = true;
+
+  inline static volatile u1 &controlA() { return *(volatile u1 *)(Base + 0); }
+  inline static volatile u1 &controlB() { return *(volatile u1 *)(Base + 1); }
+  inline static volatile u1 &controlC() { return *(volatile u1 *)(Base + 2); }
+  inline static volatile u2 &counter() { return *(volatile u2 *)(Base + 4); }
+  inline static volatile u2 &inputCapture() { return *(volatile u2 *)(Base + 6); }
+  inline static volatile u2 &compare() { return *(volatile u2 *)(Base + 8 + 2 * Channel); }
+  inline static volatile u1 &interruptMask() { return *(volatile u1 *)MaskRegister; }
+  inline static volatile u1 &interruptFlags() { return *(volatile u1 *)FlagRegister; }
+
+  // Bit positions. Same for every 16-bit timer.
+
+  // Compare Output Mode bits for this channel in TCCRnA
+  static constexpr u1 CompareOutputModeShift = 6 - 2 * Channel;
+  // Force Output Compare for this channel in TCCRnC
+  static constexpr u1 ForceOutputCompare = 1 << (7 - Channel);
+  // Interrupt enable/flag for this channel in TIMSKn/TIFRn
+  static constexpr u1 CompareMatch = 1 << (1 + Channel);
+  // Interrupt enable/flag for overflow in TIMSKn/TIFRn
+  static constexpr u1 Overflow = 1 << 0;
+
+  // Clock Select bits in TCCRnB
+  static constexpr u1 NoPrescaler = 0b001;
+
+  // Waveform Generation Mode bits, split across TCCRnA and TCCRnB
+  static constexpr u1 WGMA(u1 wgm) { return wgm & 0b11; }
+  static constexpr u1 WGMB(u1 wgm) { return (wgm & 0b1100) << 1; }
+};
+
+/**
+ * @brief Output Compare hardware for a particular pin. `exists` is false for pins without any.
+ */
+template <Ports Port, unsigned Pin>
+struct OutputCompare {
+  static constexpr bool exists = false;
+};
+
+#ifdef __AVR_ATmega32U4__
+// Timer1
+template <> struct OutputCompare<Ports::B, 5> : OutputCompareChannel<0x80, 0x6F, 0x36, 0> {};
+template <> struct OutputCompare<Ports::B, 6> : OutputCompareChannel<0x80, 0x6F, 0x36, 1> {};
+template <> struct OutputCompare<Ports::B, 7> : OutputCompareChannel<0x80, 0x6F, 0x36, 2> {};
+// Timer3
+template <> struct OutputCompare<Ports::C, 6> : OutputCompareChannel<0x90, 0x71, 0x38, 0> {};
+
+// The timers themselves, for when no pin is needed
+namespace Timers {
+using Timer1 = OutputCompareChannel<0x80, 0x6F, 0x36, 0>;
+using Timer3 = OutputCompareChannel<0x90, 0x71, 0x38, 0>;
+} // namespace Timers
+#endif
+// TODO: Support more chips here
+
+} // namespace AVR
@@ -0,0 +1,79 @@
+#pragma once
+
+/**
+ * @brief Measure how fast `ParallelPulsedOutput` sends, on the chip
+ * @file ParallelBenchmark.hpp
+ *
+ * Sends `BytesPerPin` bytes on every pin three ways: transposing only, pre-transposed masks with `sendMasks()`, and
+ * transposing as it goes with `send()`. `bytesPerSecond()` turns the cycles into throughput, counting every pin.
+ *
+ * The pins really do send, so run it with something harmless attached.
+ *
+ * Usage:
+ *
+ * ```C++
+ * #include <AVR++/ParallelBenchmark.hpp>
+ *
+ * using Strips = AVR::ParallelPulsedOutput<AVR::Ports::B, 0xff, 400>;
+ *
+ * Strips::init();
+ * cli();
+ * auto res = AVR::ParallelBenchmark::run<Strips>();
+ * sei();
+ * auto rate = AVR::ParallelBenchmark::bytesPerSecond(res.send);
+ * auto gap = AVR::ParallelBenchmark::gapCycles(res);
+ * // Send res and rate over USART
+ * ```
+ */
+
+#include "CycleCount.hpp"
+#include "ParallelPulsedOutput.cpp"
+
+namespace AVR {
+namespace ParallelBenchmark {
+using namespace Basic;
+
+constexpr u1 BytesPerPin = 8;
+
+struct Result {
+  // For BytesPerPin bytes on every pin
+  u2 transpose;
+  u2 sendMasks;
+  u2 send;
+};
+
+/**
+ * @param cycles From `Result`
+ * @param pins How many pins were sending
+ */
+inline u4 bytesPerSecond(u2 cycles, u1 pins = 8) { return u4(F_CPU) * BytesPerPin * pins / cycles; }
+
+/**
+ * @return How much `send()` stretches the low time after each byte. Compare to `PulseMath::transposeCycles`.
+ */
+inline u2 gapCycles(Result const &r) { return (r.send - r.sendMasks) / BytesPerPin; }
+
+namespace {
+u1 data[8][BytesPerPin];
+u1 masks[BytesPerPin * 8];
+} // namespace
+
+template <typename Output>
+inline Result run() {
+  for (u1 p = 0; p < 8; p++)
+    for (u1 i = 0; i < BytesPerPin; i++)
+      data[p][i] = p * 0x11 + i * 0x35;
+
+  u1 const *const lanes[8] = {data[0], data[1], data[2], data[3], data[4], data[5], data[6], data[7]};
+
+  Result r;
+
+  r.transpose = CycleCount::measure([&lanes] { Transpose::streams(lanes, BytesPerPin, masks, Output::Pins); });
+  r.sendMasks = CycleCount::measure([] { Output::sendMasks(masks, sizeof(masks)); });
+  r.send = CycleCount::measure([&lanes] { Output::send(lanes, BytesPerPin); });
+
+  return r;
+}
+
+} // namespace ParallelBenchmark
+} // namespace AVR
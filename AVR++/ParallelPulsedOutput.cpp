@@ -0,0 +1,88 @@
+#pragma once
+
+/**
+ * @file ParallelPulsedOutput.cpp
+ * @brief The implementation of the ParallelPulsedOutput class
+ * @note This file is part of the AVR++ library.
+ *
+ * @see The comments in ParallelPulsedOutput.hpp for more information on the internal workings of this implementation.
+ */
+
+#include "ParallelPulsedOutput.hpp"
+
+template <AVR::Ports Port, Basic::u1 PinMask, unsigned ShortPulseNanos, bool InvertedOutput, unsigned MinRecoveryNanos,
+          unsigned LongPulseNanos, unsigned ResetMicroseconds>
+void AVR::ParallelPulsedOutput<Port, PinMask, ShortPulseNanos, InvertedOutput, MinRecoveryNanos, LongPulseNanos,
+                               ResetMicroseconds>::init() {
+  port() = idle();
+  ddr() |= PinMask;
+}
+
+template <AVR::Ports Port, Basic::u1 PinMask, unsigned ShortPulseNanos, bool InvertedOutput, unsigned MinRecoveryNanos,
+          unsigned LongPulseNanos, unsigned ResetMicroseconds>
+void AVR::ParallelPulsedOutput<Port, PinMask, ShortPulseNanos, InvertedOutput, MinRecoveryNanos, LongPulseNanos,
+                               ResetMicroseconds>::sendMasks(u1 const *masks, u2 bits, u1 const on, u1 const off) {
+  asm volatile("; ParallelPulsedOutput::sendMasks()");
+
+  do {
+    u1 b = (*masks++ & PinMask) ^ off;
+
+    // Make sure the compiler doesn't move the load into our pulse
+    asm volatile("; Port value for this bit in %0" : "+r"(b));
+
+    asm("; CycleBudget end ParallelPulsedOutput.low");
+    asm("; CycleBudget begin ParallelPulsedOutput.short %0" : : "n"(PulseMath::realHighCyclesShort));
+    asm("; CycleBudget begin ParallelPulsedOutput.long %0" : : "n"(PulseMath::realHighCyclesLong));
+
+    port() = on;
+
+    asm("; ParallelPulsedOutput Delay A = %0 cycles" : : "I"(PulseMath::delayCyclesA));
+    nopCycles(PulseMath::delayCyclesA);
+
+    asm("; CycleBudget end ParallelPulsedOutput.short");
+    port() = b;
+
+    asm("; ParallelPulsedOutput Delay B = %0 cycles" : : "I"(PulseMath::delayCyclesB));
+    nopCycles(PulseMath::delayCyclesB);
+
+    asm("; CycleBudget end ParallelPulsedOutput.long");
+    asm("; CycleBudget begin ParallelPulsedOutput.low %0" : : "n"(PulseMath::realLowCyclesMin));
+
+    port() = off;
+
+    asm("; ParallelPulsedOutput Delay C = %0 cycles" : : "I"(PulseMath::delayCyclesC));
+    nopCycles(PulseMath::delayCyclesC);
+  } while (--bits);
+
+  // The low time of the last bit is up to the caller
+  asm("; CycleBudget stop ParallelPulsedOutput.low");
+
+  asm volatile("; ParallelPulsedOutput::sendMasks()#end");
+}
+
+template <AVR::Ports Port, Basic::u1 PinMask, unsigned ShortPulseNanos, bool InvertedOutput, unsigned MinRecoveryNanos,
+          unsigned LongPulseNanos, unsigned ResetMicroseconds>
+void AVR::ParallelPulsedOutput<Port, PinMask, ShortPulseNanos, InvertedOutput, MinRecoveryNanos, LongPulseNanos,
+                               ResetMicroseconds>::sendMasks(u1 const *masks, u2 bits) {
+  u1 const off = idle();
+  sendMasks(masks, bits, asserted(off), off);
+}
+
+template <AVR::Ports Port, Basic::u1 PinMask, unsigned ShortPulseNanos, bool InvertedOutput, unsigned MinRecoveryNanos,
+          unsigned LongPulseNanos, unsigned ResetMicroseconds>
+void AVR::ParallelPulsedOutput<Port, PinMask, ShortPulseNanos, InvertedOutput, MinRecoveryNanos, LongPulseNanos,
+                               ResetMicroseconds>::send(u1 const *const (&lanes)[8], u2 length) {
+  u1 const off = idle();
+  u1 const on = asserted(off);
+
+  for (u2 i = 0; i < length; i++) {
+    u1 group[8] = {};
+    for (u1 p = 0; p < 8; p++)
+      if (PinMask & (1 << p)) group[p] = lanes[p][i];
+
+    // Between bytes, so this stretches the low time of the last bit sent. See `PulseMath::transposeCycles`.
+    auto const m = Transpose::bits8(group, PinMask);
+
+    sendMasks(m.bits, 8, on, off);
+  }
+}
@@ -0,0 +1,189 @@
+#pragma once
+
+/**
+ * @brief PulsedOutput on up to 8 pins of the same Port at the same time
+ * @file ParallelPulsedOutput.hpp
+ *
+ * `PulsedOutput` drives one pin, so 8 WS2812 strips or 8 DShot lines take 8 times as long. This sends one byte stream
+ * per pin with whole Port writes, so they all take as long as one.
+ *
+ * Every bit is the same three writes:
+ *
+ * @details
+ *                  _______________________
+ *     all on  --> |<-- ShortPulseNanos -->|
+ *     data    --> |                       |__________  Pins sending a "0" released
+ *                  __________________________________
+ *                 |<-------- LongPulseNanos -------->|
+ *     all off --> |                                  |__  Every pin released
+ *
+ * The bytes are first turned into one Port mask per bit with `Transpose::bits8()`. `send()` does that one byte per pin
+ * at a time, which makes the low time after every 8th bit up to `PulseMath::transposeCycles` longer. That's fine for
+ * WS2812, and checked against `ResetMicroseconds` if it's given. For protocols that can't take the gap, transpose
+ * everything ahead of time with `Transpose::streams(lanes, length, masks, Pins)` and use `sendMasks()`.
+ *
+ * Other pins on the Port keep their state, but anything that writes the Port from an interrupt while we're sending
+ * gets overwritten. Interrupts are left to the caller, like `PulsedOutput`.
+ *
+ * Usage:
+ *
+ * ```main.cpp
+ * #include <AVR++/ParallelPulsedOutput.cpp> // Yes, a cpp file
+ *
+ * // WS2812 timing on PB0-PB3, with a 300us reset
+ * using Strips = AVR::ParallelPulsedOutput<AVR::Ports::B, 0x0f, 400, false, 400, 800, 300>;
+ * template class AVR::ParallelPulsedOutput<AVR::Ports::B, 0x0f, 400, false, 400, 800, 300>;
+ *
+ * u1 a[30], b[30], c[30], d[30];
+ *
+ * int main() {
+ *   Strips::init();
+ *
+ *   u1 const *const lanes[8] = {a, b, c, d};
+ *   cli();
+ *   Strips::send(lanes, sizeof(a));
+ *   sei();
+ * }
+ * ```
+ *
+ * @see ParallelBenchmark.hpp to measure the throughput on the chip
+ */
+
+#include "Const.hpp"
+#include "Nop.hpp"
+#include "Ports.hpp"
+#include "PulsedOutput.hpp"
+#include "Transpose.hpp"
+
+namespace AVR {
+using namespace Basic;
+
+/**
+ * @tparam Port The processor "Port" to use
+ * @tparam PinMask The pins of the "Port" to use. One byte stream per pin.
+ * @tparam ShortPulseNanos The length of the short pulse in nanoseconds
+ * @tparam InvertedOutput Whether to invert the output (false)
+ * @tparam MinRecoveryNanos The minimum time to wait after sending a bit before sending the next bit
+ * @tparam LongPulseNanos The length of the long pulse in nanoseconds (2x short pulse)
+ * @tparam ResetMicroseconds How long a low time the protocol treats as the end of a frame. `send()`'s longest low time
+ *                           must stay under half of it. 0 to not check. (0)
+ */
+template <Ports Port, u1 PinMask, unsigned ShortPulseNanos, bool InvertedOutput = false,
+          unsigned MinRecoveryNanos = ShortPulseNanos, unsigned LongPulseNanos = ShortPulseNanos * 2,
+          unsigned ResetMicroseconds = 0>
+class ParallelPulsedOutput {
+  static_assert(PinMask, "PinMask must select at least one pin");
+
+public:
+  /**
+   * @brief The same model as `PulsedOutput::PulseMath`, for the loop in `sendMasks()`
+   *
+   * C++             // ASM simplified ; Out Notes
+   * --------------- // -------------- ; --- --------
+   * b = *masks++    // ld r, X+       ; I   2 cycles
+   * b &= PinMask    // andi r, mask   ; I   Ignore pins that aren't ours
+   * b ^= off        // eor r, off     ; I   Only pins sending a "1" stay asserted
+   * port = on       // out PORT, on   ; A   All pins asserted
+   * delay(A)        // nop x A        ; A
+   * port = b        // out PORT, b    ; A/I Pins sending "0" released
+   * delay(B)        // nop x B        ; A/I
+   * port = off      // out PORT, off  ; I   All pins released
+   * delay(C)        // nop x C        ; I
+   * n--             // sbiw           ; I   2 cycles
+   * if (n)          // brne           ; I   2 cycles when looping
+   *
+   * Every bit takes the same time, regardless of the data.
+   *
+   * minCyclesShort = 1 (out)
+   * minCyclesLong = 1 (out)
+   * minCyclesRecover = 1 (out) + 2 (ld) + 1 (andi) + 1 (eor) + 2 (sbiw) + 2 (brne)
+   *
+   * `send()` adds up to `transposeCycles` to the low time after every 8th bit.
+   */
+  struct PulseMath : PulseCycles<ShortPulseNanos, LongPulseNanos, MinRecoveryNanos> {
+    using Cycles = PulseCycles<ShortPulseNanos, LongPulseNanos, MinRecoveryNanos>;
+    using Cycles::cyclesLong;
+    using Cycles::cyclesRecover;
+    using Cycles::cyclesShort;
+
+    static constexpr unsigned minCyclesShort = 1;
+    static constexpr unsigned minCyclesLong = 1;
+    static constexpr unsigned minCyclesRecover = 9;
+
+    static_assert(cyclesShort >= minCyclesShort, "Short pulse is too short for this F_CPU");
+    static_assert(cyclesLong >= cyclesShort + minCyclesLong, "Long pulse is too short for this F_CPU");
+
+    static constexpr unsigned delayCyclesA = cyclesShort - minCyclesShort;
+    static constexpr unsigned delayCyclesB = cyclesLong - cyclesShort - minCyclesLong;
+    static constexpr unsigned delayCyclesC = Const::max<signed>(0, cyclesRecover - minCyclesRecover);
+
+    /**
+     * A generous estimate, not a measurement, of what `send()` does between bytes. Use
+     * `ParallelBenchmark::gapCycles()` to see the real value for a build.
+     *
+     * - Each of the 8 lanes: load its pointer and byte, check PinMask, and store it in the group, ~12
+     * - Each of the 64 bits of `Transpose::bits8()`: load, shift in, and store its mask, shift the byte, loop, ~12
+     * - Loop, call, and return overhead, ~40
+     */
+    static constexpr unsigned transposeCycles = 8 * 12 + 8 * 8 * 12 + 40;
+
+    // Values that will actually be used. For developer inspection with modern editor. Not used in code.
+
+    static constexpr auto realHighCyclesShort = minCyclesShort + delayCyclesA;
+    static constexpr auto realHighCyclesLong = minCyclesShort + delayCyclesA + minCyclesLong + delayCyclesB;
+    static constexpr auto realLowCyclesMin = minCyclesRecover + delayCyclesC;
+    // At the end of a byte, with `send()`
+    static constexpr auto realLowCyclesMax = realLowCyclesMin + transposeCycles;
+
+    // Every bit, except the last of each byte with `send()`
+    static constexpr auto realBitCycles = realHighCyclesLong + realLowCyclesMin;
+
+    static constexpr auto realHighNanosecondsShort = realHighCyclesShort * 1e9 / F_CPU;
+    static constexpr auto realHighNanosecondsLong = realHighCyclesLong * 1e9 / F_CPU;
+    static constexpr auto realLowNanosecondsMin = realLowCyclesMin * 1e9 / F_CPU;
+    static constexpr auto realBitNanoseconds = realBitCycles * 1e9 / F_CPU;
+
+    static constexpr auto realLowMicrosecondsMax = realLowCyclesMax * 1e6 / F_CPU;
+  };
+
+  static_assert(!ResetMicroseconds || PulseMath::realLowMicrosecondsMax < ResetMicroseconds / 2.0,
+                "The gap send() leaves between bytes could be taken as a reset. Use sendMasks() or a faster F_CPU.");
+
+protected:
+  static inline volatile u1 &port() { return *(volatile u1 *)u1(Port); }
+  static inline volatile u1 &ddr() { return *(volatile u1 *)(u1(Port) - 1); }
+
+  // Port values with every one of our pins released, and asserted. Other pins as they are now.
+  static inline u1 idle() { return InvertedOutput ? port() | PinMask : port() & ~PinMask; }
+  static inline u1 asserted(u1 idle) { return idle ^ PinMask; }
+
+public:
+  // For `Transpose::streams()`
+  static constexpr u1 Pins = PinMask;
+
+  /**
+   * @brief Make every pin an output, released
+   */
+  static void init();
+
+  /**
+   * @brief Send masks made by `Transpose`, with every bit the same length
+   *
+   * @param masks One mask per bit, of the pins sending a "1". Bits of pins outside PinMask are ignored.
+   * @param bits The number of masks. Not 0.
+   */
+  static void sendMasks(u1 const *masks, u2 bits);
+
+  /**
+   * @brief Send one byte stream per pin, MSB first
+   *
+   * @param lanes One stream per pin, pin 0's first. Only pins in PinMask are read, so the others can be null.
+   * @param length Bytes in each stream
+   */
+  static void send(u1 const *const (&lanes)[8], u2 length);
+
+protected:
+  static void sendMasks(u1 const *masks, u2 bits, u1 on, u1 off);
+};
+
+}; // namespace AVR
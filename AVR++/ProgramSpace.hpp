@@ -0,0 +1,18 @@
+#pragma once
+
+/*
+ * File:   ProgramSpace.hpp
+ * Author: Cameron Tacklind
+ *
+ * `<avr/pgmspace.h>` on the chip. Plain memory for host side tools, like simulators, that share our tables.
+ */
+
+#ifdef __AVR__
+#include <avr/pgmspace.h>
+#else
+#include <stdint.h>
+
+#define PROGMEM
+#define pgm_read_byte(address) (*(uint8_t const *)(address))
+#define pgm_read_word(address) (*(uint16_t const *)(address))
+#endif
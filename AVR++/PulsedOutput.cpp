@@ -8,19 +8,17 @@
 using namespace AVR;
 
 template <Ports Port, unsigned Pin, unsigned ShortPulseNanos, bool InvertedOutput, bool BalanceRecoveryTimes,
-          bool LittleEndian, bool InvertBits, unsigned MinimumRecoveryNanos, unsigned LongPulseNanos>
+          bool LittleEndian, bool InvertBits, unsigned MinimumRecoveryNanos, unsigned LongPulseNanos,
+          InterruptHandling Interrupts, u1 InterruptBlockBytes>
 void PulsedOutput<Port, Pin, ShortPulseNanos, InvertedOutput, BalanceRecoveryTimes, LittleEndian, InvertBits,
-                  MinimumRecoveryNanos, LongPulseNanos>::send(u1 byte, u1 bits) {
+                  MinimumRecoveryNanos, LongPulseNanos, Interrupts, InterruptBlockBytes>::send(u1 byte, u1 bits) {
   asm volatile("; PulsedOutput::send(u1 byte, u1 bits)");
 
   // Automatically shift bits over for BigEndian?
   // if (!LittleEndian) for (u1 i = bits; i < 8; i++) byte <<= 1;
 
-  // TODO: Multiple implementations based on minimum pulse length.
-  // Current implementation optimized for enabling a 2 cycle pulse minimum.
-  // If not needed, some instructions could be saved and complexity reduced.
-
-  // if (ih == InterruptHandling::Byte) cli();
+  // Which code we generate for the end of each byte depends on how much room Delay C has. See `SendGenerator`.
+  // The rest is optimized for enabling a 2 cycle pulse minimum.
 
   /**
    * Pseudo code unbalanced pulse timing:
@@ -57,7 +55,10 @@ void PulsedOutput<Port, Pin, ShortPulseNanos, InvertedOutput, BalanceRecoveryTim
     else
       asm volatile("lsl %0 ; byte <<= 1" : "+r"(byte));
 
-    // if (ih == InterruptHandling::Bit) cli();
+    asm("; CycleBudget end PulsedOutput.low");
+    asm("; CycleBudget begin PulsedOutput.high %0 %1"
+        :
+        : "n"(PulseMath::realHighCyclesShort), "n"(PulseMath::realHighCyclesLong));
 
     on(); // assert()
 
@@ -65,21 +66,24 @@ void PulsedOutput<Port, Pin, ShortPulseNanos, InvertedOutput, BalanceRecoveryTim
     nopCycles(PulseMath::delayCyclesA - 1);
     asm("; End of PulsedOutput Delay A");
 
-    // BRanch if Carry is Clear/Set (sending a long pulse)
-    // delayB();
-    // if (InvertBits)
-    //   asm goto("brcc %l[SEND_LONG_PULSE]" :: ::SEND_LONG_PULSE);
-    // else
-    //   asm goto("brcs %l[SEND_LONG_PULSE]" :: ::SEND_LONG_PULSE);
-    if (InvertBits)
-      asm goto("brcc %l[SKIP_OFF]" :: ::SKIP_OFF);
-    else
-      asm goto("brcs %l[SKIP_OFF]" :: ::SKIP_OFF);
+    if (BalanceRecoveryTimes) {
+      // BRanch if Carry is Clear/Set (sending a long pulse), out of the loop
+      if (InvertBits)
+        asm goto("brcc %l[SEND_LONG_PULSE]" :: ::SEND_LONG_PULSE);
+      else
+        asm goto("brcs %l[SEND_LONG_PULSE]" :: ::SEND_LONG_PULSE);
+    } else {
+      if (InvertBits)
+        asm goto("brcc %l[SKIP_OFF]" :: ::SKIP_OFF);
+      else
+        asm goto("brcs %l[SKIP_OFF]" :: ::SKIP_OFF);
+    }
 
     // We use brcc/brcs because when it falls through (sending a short pulse), it only takes 1 clock cycle.
     // This enables the minimum pulse time of 2 clock cycles.
 
   OFF_JUMP:
+    asm("; CycleBudget end PulsedOutput.high");
     off(); // idle()
 
     nopCycles(1);
@@ -89,10 +93,26 @@ void PulsedOutput<Port, Pin, ShortPulseNanos, InvertedOutput, BalanceRecoveryTim
     nopCycles(PulseMath::delayCyclesB);
     asm("; End of PulsedOutput Delay B2");
 
+    // Long pulses end here without BalanceRecoveryTimes. Short pulses already did, at OFF_JUMP.
+    asm("; CycleBudget end PulsedOutput.high");
+    if (!BalanceRecoveryTimes)
+      asm("; CycleBudget begin PulsedOutput.low %0 %1"
+          :
+          : "n"(PulseMath::realLowCyclesMin), "n"(PulseMath::realLowCyclesEndOfByte));
+
     off(); // idle()
 
   RECOVERY_JUMP:
-    // if (ih == InterruptHandling::Bit) sei();
+    // Counted in minCyclesRecover
+    if (Interrupts == InterruptHandling::Bit) openInterruptWindow();
+
+    if (PulseMath::overlapped && !bits) {
+      // The outer loop, loading the next byte, takes the rest of this bit
+      asm("; PulsedOutput Delay C Last = %0 cycles" : : "I"(PulseMath::delayCyclesCLast));
+      nopCycles(PulseMath::delayCyclesCLast);
+      asm("; End of PulsedOutput Delay C Last");
+      break;
+    }
 
     asm("; PulsedOutput Delay C = %0 cycles" : : "I"(PulseMath::delayCyclesC));
     nopCycles(PulseMath::delayCyclesC);
@@ -102,22 +122,22 @@ void PulsedOutput<Port, Pin, ShortPulseNanos, InvertedOutput, BalanceRecoveryTim
     asm goto("" ::: : OFF_JUMP, RECOVERY_JUMP);
   }
 
-  // if (ih == InterruptHandling::Byte) asm volatile("reti");
-  // return;
+  asm volatile("; PulsedOutput::send(u1 byte, u1 bits)#end");
+  return;
 
-  // Jump to here for the long delay
-  // SEND_LONG_PULSE:
-  //   asm("; PulsedOutput Delay B = %0 cycles" : : "I"(PulseMath::delayCyclesB));
-  //   nopCycles(PulseMath::delayCyclesB);
-  //   asm("; End of PulsedOutput Delay B");
+  // With BalanceRecoveryTimes, long pulses jump here, out of the loop, so both bit values take the same time
+SEND_LONG_PULSE:
+  asm("; PulsedOutput Delay B = %0 cycles" : : "I"(PulseMath::delayCyclesB));
+  nopCycles(PulseMath::delayCyclesB);
+  asm("; End of PulsedOutput Delay B");
 
-  //   if (BalanceRecoveryTimes) {
-  //     off(); // idle()
-  //     asm goto("rjmp %l[RECOVERY_JUMP]; RECOVERY_JUMP" :: ::RECOVERY_JUMP);
-  //   } else {
-  //     // Get back to the normal loop
-  //     asm goto("rjmp %l[OFF_JUMP]; OFF_JUMP" :: ::OFF_JUMP);
-  //   }
+  asm("; CycleBudget end PulsedOutput.high");
+  asm("; CycleBudget begin PulsedOutput.low %0 %1"
+      :
+      : "n"(PulseMath::realLowCyclesMin), "n"(PulseMath::realLowCyclesEndOfByte));
 
-  asm volatile("; PulsedOutput::send(u1 byte, u1 bits)#end");
+  off(); // idle()
+
+  asm goto("rjmp %l[RECOVERY_JUMP]" :: ::RECOVERY_JUMP);
+  __builtin_unreachable();
 }
@@ -6,12 +6,56 @@
 
 namespace AVR {
 
-// enum class InterruptHandling {
-//   None,
-//   Bit,
-//   Byte,
-//   Block,
-// };
+/**
+ * @brief How `PulsedOutput::send()` spends the low time of the last bit of each byte
+ *
+ * Chosen by `PulseMath::generator`. Not a template parameter.
+ */
+enum class SendGenerator : u1 {
+  // Straight to the outer loop after the last bit. That low time is stretched by the outer loop.
+  Tight,
+  // Every bit checks if it's the last of its byte and, if so, shortens its Delay C by the outer loop (loading the next
+  // byte). Needs room in Delay C for the check and the outer loop. The end of a byte then adds nothing to its low time,
+  // as long as the outer loop is the plain one of `send(data, bytes)`.
+  Overlapped,
+};
+
+/**
+ * @brief Where `PulsedOutput` briefly lets pending interrupts run while sending
+ *
+ * The caller disables interrupts before sending. Each window is `sei`, `nop`, `cli`: any pending interrupt runs there,
+ * in the low time of a bit, and stretches it by however long that ISR takes.
+ */
+enum class InterruptHandling : u1 {
+  // Never. Interrupts stay however the caller left them.
+  None,
+  // In the low time of every bit
+  Bit,
+  // After every byte
+  Byte,
+  // After every InterruptBlockBytes bytes
+  Block,
+};
+
+/**
+ * @brief The pulse lengths of a protocol in CPU cycles
+ *
+ * The part of `PulseMath` that doesn't depend on the send loop. Shared by `PulsedOutput` and `ParallelPulsedOutput`.
+ */
+template <unsigned ShortPulseNanos, unsigned LongPulseNanos, unsigned MinRecoveryNanos>
+struct PulseCycles {
+  // Positive length of output on for "0" bit (for non-inverted output/bits)
+  static constexpr double pulseLengthShort = ShortPulseNanos / 1e9;
+  // Positive length of output on for "1" bit
+  static constexpr double pulseLengthLong = LongPulseNanos / 1e9;
+  // Minimum length of off state
+  static constexpr double pulseLengthRecover = MinRecoveryNanos / 1e9;
+
+  // Cycles needed by microprocessor to achieve the desired periods
+  static constexpr unsigned cyclesShort = Const::round(F_CPU * pulseLengthShort);
+  static constexpr unsigned cyclesLong = Const::round(F_CPU * pulseLengthLong);
+  static constexpr unsigned cyclesRecover = Const::round(F_CPU * pulseLengthRecover);
+};
 
 /**
  * @brief Output that can handle a pulse length encoded bit digital protocol
@@ -36,11 +80,15 @@ namespace AVR {
  * @tparam LittleEndian Whether to send the least significant bit first (false)
  * @tparam InvertBits Whether to invert the long/short pulse meaning of bits (false)
  * @tparam MinRecoveryNanos The minimum time to wait after sending a bit before sending the next bit (0)
- * @tparam BalanceRecoveryTimes Make pulses start at regular intervals (false) [Not Yet Implemented]
+ * @tparam BalanceRecoveryTimes Make pulses start at regular intervals, even across bytes if `load` is a plain read
+ *                              (false)
+ * @tparam Interrupts Where to let pending interrupts run while sending (None)
+ * @tparam InterruptBlockBytes Bytes between interrupt windows with InterruptHandling::Block (1)
  */
 template <Ports Port, unsigned Pin, unsigned ShortPulseNanos, bool InvertedOutput = false,
           bool BalanceRecoveryTimes = false, bool LittleEndian = false, bool InvertBits = false,
-          unsigned MinRecoveryNanos = ShortPulseNanos, unsigned LongPulseNanos = ShortPulseNanos * 2>
+          unsigned MinRecoveryNanos = ShortPulseNanos, unsigned LongPulseNanos = ShortPulseNanos * 2,
+          InterruptHandling Interrupts = InterruptHandling::None, u1 InterruptBlockBytes = 1>
 class PulsedOutput : protected Output<Port, Pin, InvertedOutput> {
 protected:
   using Output<Port, Pin, InvertedOutput>::on;
@@ -48,6 +96,8 @@ protected:
   using Output<Port, Pin, InvertedOutput>::input;
   using Output<Port, Pin, InvertedOutput>::output;
 
+  static_assert(Interrupts != InterruptHandling::Block || InterruptBlockBytes, "InterruptBlockBytes must not be 0");
+
 public:
   using Output<Port, Pin, InvertedOutput>::init;
 
@@ -55,19 +105,11 @@ public:
    * @brief Group all math for pulse lengths into a single struct to de-clutter main namespace
    *
    */
-  struct PulseMath {
-
-    // Positive length of output on for "0" bit (for non-inverted output/bits)
-    static constexpr double pulseLengthShort = ShortPulseNanos / 1e9;
-    // Positive length of output on for "1" bit
-    static constexpr double pulseLengthLong = LongPulseNanos / 1e9;
-    // Minimum length of off state
-    static constexpr double pulseLengthRecover = MinRecoveryNanos / 1e9;
-
-    // Cycles needed by microprocessor to achieve the desired periods
-    static constexpr unsigned cyclesShort = Const::round(F_CPU * pulseLengthShort);
-    static constexpr unsigned cyclesLong = Const::round(F_CPU * pulseLengthLong);
-    static constexpr unsigned cyclesRecover = Const::round(F_CPU * pulseLengthRecover);
+  struct PulseMath : PulseCycles<ShortPulseNanos, LongPulseNanos, MinRecoveryNanos> {
+    using Cycles = PulseCycles<ShortPulseNanos, LongPulseNanos, MinRecoveryNanos>;
+    using Cycles::cyclesLong;
+    using Cycles::cyclesRecover;
+    using Cycles::cyclesShort;
 
     /**
      * In order to get accurate transition times, we need to know how long other instructions that are used/executed
@@ -124,25 +166,107 @@ public:
      * delayCyclesA = cyclesShort - minCyclesShort
      * delayCyclesB = cyclesLong - minCyclesLong - delayCyclesA
      * delayCyclesC = cyclesLow - minCyclesRecover
+     *
+     * Notice the low time of a "0" bit starts at the first `off()`, so it has `cbi`, `nop`, and Delay B more than a
+     * "1". The last bit of each byte is outerLoopExtraCycles longer.
+     *
+     * Notice most of a slow bit is Delay A, B, and C. Anything useful done in Delay A or B would have to take the same
+     * time for both bit values and never touch the carry flag, so nothing is moved into them. Which code is generated
+     * is picked by the delays. See `SendGenerator`.
+     *
+     * With `SendGenerator::Overlapped`, every bit checks if it's the last of its byte and, if so, uses a Delay C that's
+     * shorter by the outer loop. When Delay C has room for that, it's used. Otherwise, `SendGenerator::Tight`. The
+     * outer loop still runs after the bit, not in the delay, so this only holds while it takes outerLoopExtraCycles:
+     * `send(data, bytes)`, with `send(byte)` inlined. Whatever a `load` takes beyond a plain read stretches the low
+     * time after each byte.
+     *
+     * With BalanceRecoveryTimes, a long pulse instead branches out of the loop, waits Delay B, turns off, and jumps
+     * back to Delay C. That makes both bit values take the same time. It's always Overlapped, with Delay C made long
+     * enough if it has to be.
+     *
+     * C++       // ASM simplified ; Out Notes
+     * --------- // -------------- ; --- --------
+     * ...                           A   Same as above, up to the branch
+     * if (bit)  // brcs long      ; A   test bit. is high. branch out of the loop
+     *                             ; A   brcs takes 2 clock cycles when branching
+     * delay(B)  // nop x B        ; A   Delay B
+     * off()     // cbi Port,Pin   ; I   Turn off
+     * goto      // rjmp recovery  ; I   Jump back into the loop
+     *                             ; I   rjmp takes 2 clock cycles
+     * if (last) // tst, breq      ; I   Check for the end of the byte
+     * delay(C)  // nop x C        ; I   Delay C, or Delay C Last
+     * ...
+     *
+     * A "0" still takes the fall through path above, which is now the same length.
+     *
+     * minCyclesRecoverOverlapped = minCyclesRecover + 2 (tst, breq)
+     * minCyclesRecoverBalanced = minCyclesRecoverOverlapped + 2 (rjmp)
+     * delayCyclesCLast = delayCyclesC - outerLoopExtraCycles - 1 (breq taken)
+     *
+     * Every bit is then realBitCycles long, with the plain outer loop.
      */
 
+    /**
+     * `sei`, `nop`, `cli`, not counting any ISR. With InterruptHandling::Bit, it's at the start of every Delay C.
+     * With Byte or Block, it's in the outer loop. Block also counts bytes: `dec`, `brne`, and reloading the count.
+     */
+    static constexpr unsigned interruptWindowCycles = 3;
+    static constexpr unsigned interruptOuterLoopCycles =
+        Interrupts == InterruptHandling::Byte    ? interruptWindowCycles
+        : Interrupts == InterruptHandling::Block ? interruptWindowCycles + 3
+                                                 : 0;
+
     // The number of instructions it takes to turn on the output and possibly skip the second delay
 
     static constexpr unsigned minCyclesShort = 2;
     static constexpr unsigned minCyclesLong = 5;
-    static constexpr unsigned minCyclesRecover = 5;
+    static constexpr unsigned minCyclesRecover = 5 + (Interrupts == InterruptHandling::Bit ? interruptWindowCycles : 0);
     static constexpr unsigned outerLoopExtraCycles = 7;
 
     static constexpr unsigned delayCyclesA = Const::max<signed>(0, cyclesShort - minCyclesShort);
     static constexpr unsigned delayCyclesB = Const::max<signed>(0, cyclesLong - minCyclesLong - delayCyclesA);
-    static constexpr unsigned delayCyclesC = Const::max<signed>(0, cyclesRecover - minCyclesRecover);
+
+    static constexpr unsigned minCyclesRecoverOverlapped = minCyclesRecover + 2;
+    static constexpr unsigned minCyclesRecoverBalanced = minCyclesRecoverOverlapped + 2;
+    static constexpr unsigned lastBitSavedCycles = outerLoopExtraCycles + 1;
+
+    // Whether Delay C, as needed for MinRecoveryNanos, is long enough to hide the outer loop in the last bit
+    static constexpr bool roomToOverlap = cyclesRecover >= minCyclesRecoverOverlapped + lastBitSavedCycles;
+
+    static constexpr SendGenerator generator =
+        BalanceRecoveryTimes || roomToOverlap ? SendGenerator::Overlapped : SendGenerator::Tight;
+    static constexpr bool overlapped = generator == SendGenerator::Overlapped;
+
+    static constexpr unsigned minCyclesRecoverUsed = BalanceRecoveryTimes ? minCyclesRecoverBalanced
+                                                     : overlapped         ? minCyclesRecoverOverlapped
+                                                                          : minCyclesRecover;
+
+    // Balanced needs enough Delay C to hide the outer loop in the last bit of each byte
+    static constexpr unsigned delayCyclesC =
+        overlapped ? Const::max<signed>(lastBitSavedCycles, cyclesRecover - minCyclesRecoverUsed)
+                   : Const::max<signed>(0, cyclesRecover - minCyclesRecover);
+    static constexpr unsigned delayCyclesCLast = overlapped ? delayCyclesC - lastBitSavedCycles : delayCyclesC;
 
     // Values that will actually be used. For developer inspection with modern editor. Not used in code.
 
     static constexpr auto realHighCyclesShort = minCyclesShort + delayCyclesA;
     static constexpr auto realHighCyclesLong = minCyclesLong + delayCyclesA + delayCyclesB;
-    static constexpr auto realLowCyclesMin = minCyclesRecover + delayCyclesC;
-    static constexpr auto realLowCyclesMax = realLowCyclesMin + outerLoopExtraCycles;
+    // A "1" bit, from the last `off()`
+    static constexpr auto realLowCyclesMin = minCyclesRecoverUsed + delayCyclesC;
+    // After the last bit of each byte, with the plain outer loop of `send(data, bytes)`
+    static constexpr auto realLowCyclesEndOfByte =
+        realLowCyclesMin + (overlapped ? 0 : outerLoopExtraCycles) + interruptOuterLoopCycles;
+    // A "0" bit starts its low time at the first `off()`: `cbi`, `nop`, and Delay B before the one every bit shares
+    static constexpr unsigned shortBitExtraLowCycles = 3 + delayCyclesB;
+    // A "0" at the end of a byte. Balanced, a "0" only makes up for its shorter high time.
+    static constexpr auto realLowCyclesMax =
+        BalanceRecoveryTimes ? realLowCyclesMin + realHighCyclesLong - realHighCyclesShort + interruptOuterLoopCycles
+                             : realLowCyclesEndOfByte + shortBitExtraLowCycles;
+
+    // Every bit with BalanceRecoveryTimes. Otherwise, the shortest bit.
+    static constexpr auto realBitCycles = realHighCyclesLong + realLowCyclesMin;
+    // The longest bit, a "0" at the end of a byte
+    static constexpr auto realBitCyclesMax = realHighCyclesShort + realLowCyclesMax;
 
     static constexpr auto realHighTimeShort = realHighCyclesShort / double(F_CPU);
     static constexpr auto realHighTimeLong = realHighCyclesLong / double(F_CPU);
@@ -152,12 +276,29 @@ public:
     static constexpr auto realHighNanosecondsShort = realHighTimeShort * 1e9;
     static constexpr auto realHighNanosecondsLong = realHighTimeLong * 1e9;
     static constexpr auto realLowNanosecondsMin = realLowTimeMin * 1e9;
+    static constexpr auto realBitNanoseconds = realBitCycles * 1e9 / F_CPU;
+    static constexpr auto realBitNanosecondsMax = realBitCyclesMax * 1e9 / F_CPU;
 
     static constexpr auto realLowMicrosecondsMax = realLowTimeMax * 1e6;
+
+    /**
+     * The longest low time when an ISR that takes `isrMicroseconds`, from the interrupt to the end of its `reti`, runs
+     * in an interrupt window. Compare to how long the protocol allows the line to be low.
+     */
+    static constexpr double realLowMicrosecondsMaxWithISR(double isrMicroseconds) {
+      return realLowMicrosecondsMax + (Interrupts == InterruptHandling::None ? 0 : isrMicroseconds);
+    }
   };
 
+protected:
+  inline static void openInterruptWindow() { asm volatile("sei\n\tnop\n\tcli ; Interrupt window" ::: "memory"); }
+
 public:
-  static void send(u1 byte, u1 bits = 8);
+  /**
+   * Always inlined, so the low time after the last bit of each byte runs straight into the outer loop of
+   * `send(data, bytes, load)` and can be checked with it. See tools/cycle-budget.py.
+   */
+  static inline void send(u1 byte, u1 bits = 8) __attribute__((always_inline));
 
   /**
    * @brief Shift an array of bits (packed as bytes) out the specified pin
@@ -166,8 +307,35 @@ public:
    * @param bytes the number of bytes to send
    */
   static inline void send(u1 const *data, u1 bytes) {
-    while (bytes--)
-      send(*data++);
+    send(data, bytes, [](u1 const *byte) { return *byte; });
+  }
+
+  /**
+   * @brief Like `send(data, bytes)`, but each byte is read by `load`, which can also change it
+   *
+   * `load` runs in the low time after the last bit of each byte, so however long it takes beyond a plain read adds to
+   * that low time, on top of `PulseMath::realLowCyclesMax`. With BalanceRecoveryTimes, those bits come late.
+   *
+   * @param load Called with a pointer to each byte. Returns the byte to send. Taken by reference so it can keep state
+   *             across calls.
+   */
+  template <typename Load>
+  static inline void send(u1 const *data, u1 bytes, Load &&load) {
+    u1 block = InterruptBlockBytes;
+
+    while (bytes--) {
+      send(load(data++));
+
+      if (Interrupts == InterruptHandling::Byte) openInterruptWindow();
+
+      if (Interrupts == InterruptHandling::Block && !--block) {
+        openInterruptWindow();
+        block = InterruptBlockBytes;
+      }
+    }
+
+    // The low time after the last byte is up to the caller
+    asm("; CycleBudget stop PulsedOutput.low");
   }
 };
 
@@ -0,0 +1,76 @@
+#pragma once
+
+/**
+ * @brief Compare the float and fixed-point speed conversions of `Response` on the chip
+ * @file RPMBenchmark.hpp
+ *
+ * Every conversion is run on the same 8 Responses, one per exponent, with bases spread over the whole range.
+ * The cost of the loop itself is reported separately so it can be subtracted.
+ *
+ * Usage:
+ *
+ * ```C++
+ * #include <AVR++/RPMBenchmark.hpp>
+ *
+ * cli();
+ * auto res = AVR::DShot::RPMBenchmark::run();
+ * sei();
+ * // Send res over USART
+ * ```
+ */
+
+#include "BDShot.hpp"
+#include "CycleCount.hpp"
+
+namespace AVR {
+namespace DShot {
+namespace RPMBenchmark {
+using namespace Basic;
+
+constexpr u1 PolePairs = 7;
+
+struct Result {
+  // For 8 Responses
+  u2 loop;
+  u2 floatRPM;
+  u2 floatMechanicalRPM;
+  u2 fixedERPM;
+  u2 fixedMechanicalRPM;
+  u2 fixedHz;
+};
+
+namespace {
+template <typename F>
+inline u2 responses(F convert) {
+  return AVR::CycleCount::measure([convert] {
+    u1 sink = 0;
+    for (u1 e = 0; e < Response::ExponentMax; e++) {
+      // Low bits of the base from 0xff down to 0x01. Exponent in the top bits of msb. Not telemetry.
+      u1 lsb = 0xff >> e;
+      u1 msb = e << 1 | 1;
+      // Don't let the compiler know what we're converting
+      asm volatile("" : "+r"(lsb), "+r"(msb));
+      auto const r = convert(Response{lsb, msb});
+      sink ^= u1(r);
+    }
+    asm volatile("" ::"r"(sink));
+  });
+}
+} // namespace
+
+inline Result run() {
+  Result r;
+
+  r.loop = responses([](Response res) { return u1(res.getBase()); });
+  r.floatRPM = responses([](Response res) { return res.getRPM(); });
+  r.floatMechanicalRPM = responses([](Response res) { return res.getRPM(PolePairs); });
+  r.fixedERPM = responses([](Response res) { return res.getERPM(); });
+  r.fixedMechanicalRPM = responses([](Response res) { return res.getMechanicalRPM<PolePairs>(); });
+  r.fixedHz = responses([](Response res) { return res.getHz(); });
+
+  return r;
+}
+
+} // namespace RPMBenchmark
+} // namespace DShot
+} // namespace AVR
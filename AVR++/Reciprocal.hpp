@@ -0,0 +1,114 @@
+#pragma once
+
+/**
+ * @brief Divide a constant by a base/exponent period without a division
+ * @file Reciprocal.hpp
+ *
+ * BDShot reports periods as a 9-bit base shifted by a 3-bit exponent. Turning that into a speed is a division, which
+ * is hundreds of cycles on an AVR, even more in `float`.
+ *
+ * Instead, the base is normalized to a mantissa in [256, 511] and the reciprocal of that mantissa, already multiplied
+ * by the constant, is looked up in a 256 entry table in flash. Everything else is shifts.
+ *
+ * Each table is 512 bytes of flash, one per Numerator/Divisor pair that is actually used.
+ *
+ * Accuracy, compared to an exact division: Table entries are at least 2^14 and rounded, so they are off by at most
+ * 1 part in 32768. The result is then rounded to the nearest integer. So, within `0.5 + exact / 32768`.
+ * `float` division is exact to within its 24-bit mantissa, so this is a little worse, and well below the precision of
+ * the 9-bit base the ESC sent.
+ *
+ * Results that don't fit in 24 bits saturate to `Saturated`. A base of 0 does too.
+ */
+
+#include "basicTypes.hpp"
+#include "ProgramSpace.hpp"
+
+namespace Reciprocal {
+using namespace Basic;
+
+constexpr static unsigned MantissaBits = 9;
+constexpr static unsigned Entries = 1 << (MantissaBits - 1);
+constexpr static u2 MantissaMin = Entries;
+
+constexpr static u3 Saturated = 0xffffff;
+
+/**
+ * @brief Numerator / (Divisor * m) for every mantissa m, scaled by 2^Shift to use all 16 bits
+ */
+template <u4 Numerator, u1 Divisor>
+struct Table {
+  /**
+   * The largest shift (possibly negative) that keeps the biggest entry, for m = 256, in 16 bits
+   */
+  static constexpr signed char findShift() {
+    double biggest = double(Numerator) / Divisor / MantissaMin;
+    signed char s = 0;
+    while (biggest >= 0xffff) {
+      biggest /= 2;
+      s--;
+    }
+    while (biggest * 2 < 0xffff) {
+      biggest *= 2;
+      s++;
+    }
+    return s;
+  }
+
+  static constexpr signed char Shift = findShift();
+
+  u2 values[Entries];
+
+  constexpr Table() : values{} {
+    for (u2 i = 0; i < Entries; i++) {
+      double const exact = double(Numerator) / Divisor / (MantissaMin + i);
+      double const scaled = Shift < 0 ? exact / (1ul << -Shift) : exact * (1ul << Shift);
+      values[i] = u2(scaled + 0.5);
+    }
+  }
+
+  constexpr u2 operator[](u2 i) const { return values[i]; }
+};
+
+template <u4 Numerator, u1 Divisor>
+constexpr static Table<Numerator, Divisor> TableFlash PROGMEM{};
+
+namespace SelfTest {
+static_assert(Table<60000000, 1>::Shift == -2, "60e6/256 should need 2 bits dropped to fit");
+static_assert(Table<60000000, 1>{}[0] == 58594, "60e6/256/4 rounded");
+static_assert(Table<1000000, 1>::Shift == 4, "1e6/256 should gain 4 bits to fill 16");
+static_assert(Table<1000000, 1>{}[0] == 62500, "1e6/256*16 exactly");
+static_assert(Table<60000000, 7>{}[Entries - 1] > 1 << 14, "Every entry should keep at least 14 bits");
+} // namespace SelfTest
+
+/**
+ * @brief Numerator / (Divisor * (base << exponent)), rounded
+ *
+ * About 100 cycles worst case. Longer for small bases and big exponents, which need more shifts.
+ *
+ * @param base 9-bit base
+ * @param exponent 3-bit exponent
+ */
+template <u4 Numerator, u1 Divisor = 1>
+inline static u3 divide(u2 base, u1 exponent) {
+  using T = Table<Numerator, Divisor>;
+
+  if (!base) return Saturated;
+
+  // Normalize so the top bit of the mantissa is set
+  signed char shift = -exponent - T::Shift;
+  while (!(base & MantissaMin)) {
+    base <<= 1;
+    shift++;
+  }
+
+  auto const &table = TableFlash<Numerator, Divisor>;
+  u3 const r = pgm_read_word(&table.values[u1(base)]);
+
+  if (shift <= 0) return (r + (u3(1) << -shift >> 1)) >> -shift;
+
+  if (shift > 24 - 16 && r >> (24 - shift)) return Saturated;
+
+  return r << shift;
+}
+
+} // namespace Reciprocal
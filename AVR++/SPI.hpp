@@ -40,9 +40,9 @@ typedef union {
   u1 byte;
 } SRt;
 
-constexpr volatile CRt *const CR = (volatile CRt *const)&SPCR;
-constexpr volatile SRt *const SR = (volatile SRt *const)&SPSR;
-constexpr volatile u1 *const DR = &SPDR;
+volatile CRt *const CR = (volatile CRt *const)&SPCR;
+volatile SRt *const SR = (volatile SRt *const)&SPSR;
+volatile u1 *const DR = &SPDR;
 
 #ifdef __AVR_ATmega32U4__
 using SS = IOpin<Ports::B, 0>;
@@ -0,0 +1,85 @@
+#pragma once
+
+/**
+ * @brief Turn 8 byte streams into one Port mask per bit
+ * @file Transpose.hpp
+ *
+ * Sending the same bit of 8 bytes at once, one per pin, needs the bits regrouped: the first mask has the MSB of every
+ * byte, pin 0's in bit 0, pin 1's in bit 1, and so on. The last mask has every LSB. That's an 8x8 bit matrix
+ * transpose.
+ *
+ * This is plain C++ with no hardware access so it can be compiled and checked on a PC too. On the chip, the inner loop
+ * compiles to a shift and a rotate through carry per bit.
+ */
+
+#include "basicTypes.hpp"
+
+namespace Transpose {
+using namespace Basic;
+
+/**
+ * @brief One mask per bit, MSB first
+ */
+struct Masks {
+  u1 bits[8];
+
+  constexpr u1 operator[](u1 i) const { return bits[i]; }
+};
+
+/**
+ * @brief Transpose one byte per pin into one mask per bit
+ *
+ * @param lanes 8 bytes, pin 0's first. Only pins in `mask` are read.
+ * @param mask Pins to include. Others are 0 in every mask.
+ */
+constexpr Masks bits8(u1 const *lanes, u1 mask = 0xff) {
+  Masks m{};
+
+  // Highest pin first so each one ends up shifted into its own bit
+  for (u1 p = 8; p--;) {
+    u1 b = mask & (1 << p) ? lanes[p] : 0;
+    for (u1 i = 0; i < 8; i++) {
+      m.bits[i] = m.bits[i] << 1 | b >> 7;
+      b <<= 1;
+    }
+  }
+
+  return m;
+}
+
+/**
+ * @brief Transpose whole streams into a buffer of masks, for sending without gaps
+ *
+ * @param lanes One stream per pin, pin 0's first. Only pins in `mask` are read. Null lanes send 0s.
+ * @param length Bytes in each stream
+ * @param out `length * 8` masks
+ * @param mask Pins to include, like `PinMask` of the output. Others are 0 in every mask.
+ */
+inline void streams(u1 const *const (&lanes)[8], u2 length, u1 *out, u1 mask = 0xff) {
+  for (u1 p = 0; p < 8; p++)
+    if (!lanes[p]) mask &= ~(1 << p);
+
+  for (u2 i = 0; i < length; i++) {
+    u1 group[8] = {};
+    for (u1 p = 0; p < 8; p++)
+      if (mask & (1 << p)) group[p] = lanes[p][i];
+
+    auto const m = bits8(group, mask);
+    for (u1 b = 0; b < 8; b++)
+      *out++ = m[b];
+  }
+}
+
+namespace SelfTest {
+constexpr u1 identity[8] = {0x80, 0x40, 0x20, 0x10, 0x08, 0x04, 0x02, 0x01};
+constexpr u1 pattern[8] = {0xff, 0x00, 0xa5, 0x0f, 0x01, 0x80, 0x3c, 0x00};
+
+static_assert(bits8(identity)[0] == 0x01, "Pin 0's MSB should be bit 0 of the first mask");
+static_assert(bits8(identity)[7] == 0x80, "Pin 7's LSB should be bit 7 of the last mask");
+static_assert(bits8(pattern)[0] == 0b00100101, "MSBs of pins 0, 2, and 5");
+static_assert(bits8(pattern)[7] == 0b00011101, "LSBs of pins 0, 2, 3, and 4");
+static_assert(bits8(pattern, 0x0f)[7] == 0b00001101, "Pins outside the mask should be 0");
+static_assert(bits8(pattern)[4] == 0b01001001, "Bit 3 of pins 0, 3, and 6");
+} // namespace SelfTest
+
+} // namespace Transpose
@@ -41,26 +41,50 @@ using namespace AVR;
  * |                      \___________________\___Recovery Time___|
  *
  * If the line is held low for a longer time period (> ~40us), all pixels will latch their latest values.
+ *
+ * With HandleInterrupts, interrupts are off while sending, which is 30us per pixel. `Interrupts` lets pending ones run
+ * in the low time after every bit, byte, or few bytes instead. Whatever they take adds to that low time, so the
+ * longest ISR, `MaxISRMicroseconds`, is checked against `ResetMicroseconds`.
  */
 
 template <Ports Port, u1 Pin, bool StrictTiming, bool HandleInterrupts, unsigned ResetMicroseconds, bool InvertedLogic,
-          bool LittleEndian>
-void WS2812<Port, Pin, StrictTiming, HandleInterrupts, ResetMicroseconds, InvertedLogic, LittleEndian>::sendBytes(
-    u1 const *const data, u2 length) {
-  if (HandleInterrupts) asm("cli");
+          bool LittleEndian, InterruptHandling Interrupts, unsigned MaxISRMicroseconds, u1 InterruptBlockBytes,
+          typename Latch>
+void WS2812<Port, Pin, StrictTiming, HandleInterrupts, ResetMicroseconds, InvertedLogic, LittleEndian, Interrupts,
+            MaxISRMicroseconds, InterruptBlockBytes, Latch>::sendBytes(u1 const *data, u2 length) {
+  Latch::template wait<ResetMicroseconds>();
+
+  if (HandleInterrupts) asm volatile("cli");
+
+  // `send()` counts bytes in 8 bits
+  while (length > 0xff) {
+    send(data, 0xff);
+    data += 0xff;
+    length -= 0xff;
+  }
 
   send(data, length);
 
-  if (HandleInterrupts)
-    asm("reti");
-  else
-    return;
+  if (HandleInterrupts) asm volatile("sei");
+}
+
+template <Ports Port, u1 Pin, bool StrictTiming, bool HandleInterrupts, unsigned ResetMicroseconds, bool InvertedLogic,
+          bool LittleEndian, InterruptHandling Interrupts, unsigned MaxISRMicroseconds, u1 InterruptBlockBytes,
+          typename Latch>
+template <typename Load>
+void WS2812<Port, Pin, StrictTiming, HandleInterrupts, ResetMicroseconds, InvertedLogic, LittleEndian, Interrupts,
+            MaxISRMicroseconds, InterruptBlockBytes, Latch>::sendBytes(u1 const *data, u2 length, Load load) {
+  Latch::template wait<ResetMicroseconds>();
+
+  if (HandleInterrupts) asm volatile("cli");
+
+  while (length > 0xff) {
+    send(data, 0xff, load);
+    data += 0xff;
+    length -= 0xff;
+  }
 
-  static_assert(Parent::PulseMath::realHighNanosecondsShort <= 400 + 150,
-                "Short pulse period is too long. Check F_CPU and WS2812 timing.");
+  send(data, length, load);
 
-  // This test depends on `ResetMicroseconds` so it needs to be inside a templated function.
-  static_assert(Parent::PulseMath::realLowMicrosecondsMax < ResetMicroseconds / 2,
-                "Low period is too long and could be considered a \"reset\". "
-                "Check F_CPU and WS2812 timing.");
+  if (HandleInterrupts) asm volatile("sei");
 }
@@ -1,17 +1,47 @@
 #pragma once
 
+#include "FlashReader.hpp"
+#include "ProgramSpace.hpp"
 #include "PulsedOutput.hpp"
+#include "WS2812Latch.hpp"
+#include "WS2812Pixels.hpp"
 #include <util/delay.h>
 
 namespace AVR {
 
+/**
+ * @tparam HandleInterrupts Disable interrupts while sending, and enable them after (true)
+ * @tparam Interrupts Where to let pending interrupts run while sending. Needs HandleInterrupts. (None)
+ * @tparam MaxISRMicroseconds The longest any ISR that could run in a window takes, from the interrupt to its `reti`.
+ *                            Checked at compile time against ResetMicroseconds.
+ * @tparam InterruptBlockBytes Bytes between windows with InterruptHandling::Block (3, one RGB pixel)
+ * @tparam Latch How to wait out ResetMicroseconds after sending. Right away, or before the next send. See
+ *               WS2812Latch.hpp. (WS2812Latch::Delay)
+ */
 template <Ports port, u1 pin, bool StrictTiming = false, bool HandleInterrupts = true, unsigned ResetMicroseconds = 300,
-          bool InvertedOutput = false, bool LittleEndian = false>
-class WS2812 : protected PulsedOutput<port, pin, 400, InvertedOutput, StrictTiming> {
-  using Parent = PulsedOutput<port, pin, 400, InvertedOutput, StrictTiming>;
+          bool InvertedOutput = false, bool LittleEndian = false,
+          InterruptHandling Interrupts = InterruptHandling::None, unsigned MaxISRMicroseconds = 0,
+          u1 InterruptBlockBytes = 3, typename Latch = WS2812Latch::Delay>
+class WS2812 : protected PulsedOutput<port, pin, 400, InvertedOutput, StrictTiming, false, false, 400, 800, Interrupts,
+                                      InterruptBlockBytes> {
+  using Parent = PulsedOutput<port, pin, 400, InvertedOutput, StrictTiming, false, false, 400, 800, Interrupts,
+                              InterruptBlockBytes>;
 
   using Parent::send;
 
+  static_assert(Parent::PulseMath::realHighNanosecondsShort <= 400 + 150,
+                "Short pulse period is too long. Check F_CPU and WS2812 timing.");
+
+  static_assert(HandleInterrupts || Interrupts == InterruptHandling::None,
+                "Interrupt windows would enable interrupts the caller disabled. Use HandleInterrupts.");
+
+  static_assert(Interrupts == InterruptHandling::None || MaxISRMicroseconds,
+                "Set MaxISRMicroseconds to the longest ISR that could run in an interrupt window.");
+
+  static_assert(Parent::PulseMath::realLowMicrosecondsMaxWithISR(MaxISRMicroseconds) < ResetMicroseconds / 2,
+                "Low period, including the longest ISR, is too long and could be considered a \"reset\". "
+                "Check F_CPU, WS2812 timing, and MaxISRMicroseconds.");
+
 protected:
   /**
    * @brief Shift an array of bytes out the specified pin using the WS2812 protocol.
@@ -22,51 +52,147 @@ protected:
    * @param length the number of bytes to send
    */
   static void sendBytes(u1 const *const bytes, u2 length);
-  // naked, in our case, just removes the automatic "ret" which we do ourselves.
+
+  /**
+   * @brief Like `sendBytes()`, but each byte is read with `load`
+   *
+   * @see `PulsedOutput::send(data, bytes, load)`
+   */
+  template <typename Load>
+  static void sendBytes(u1 const *const bytes, u2 length, Load load) __attribute__((noinline));
+
+  static inline void sendScaled(u1 const *bytes, u2 length, u1 brightness) {
+    sendBytes(bytes, length, [brightness](u1 const *b) { return WS2812Pixels::scale(*b, brightness); });
+  }
+  static inline void sendScaled(u1 const *bytes, u2 length, u1 brightness, u1 const *gamma) {
+    sendBytes(bytes, length, [brightness, gamma](u1 const *b) {
+      return pgm_read_byte(gamma + WS2812Pixels::scale(*b, brightness));
+    });
+  }
 
 public:
   using Parent::init;
 
-  struct RGB {
-    // This order matches the order of the WS2812 protocol
-
-    u1 g;
-    u1 r;
-    u1 b;
-    RGB() : g(0), r(0), b(0) {}
-    RGB(u1 w) : g(w), r(w), b(w) {}
-    RGB(u1 r, u1 g, u1 b) : g(g), r(r), b(b) {}
-
-    inline u1 const *data() const { return (u1 const *)this; }
-    inline operator u1 const *() const { return data(); }
-    static constexpr u1 size = sizeof(RGB);
-  };
-  struct RGBW {
-    // This order matches the order of the WS2812 protocol
-
-    u1 g;
-    u1 r;
-    u1 b;
-    u1 w;
-    RGBW() : g(0), r(0), b(0), w(0) {}
-    RGBW(u1 w) : g(0), r(0), b(0), w(w) {}
-    RGBW(u1 r, u1 g, u1 b, u1 w = 0) : g(g), r(r), b(b), w(w) {}
-
-    inline u1 const *data() const { return (u1 const *)this; }
-    inline operator u1 const *() const { return data(); }
-    static constexpr u1 size = sizeof(RGBW);
-  };
+  using RGB = WS2812Pixels::RGB;
+  using RGBW = WS2812Pixels::RGBW;
 
   template <bool doLatchDelay = true>
   inline static void setLEDs(RGB const *leds, u2 pixels) {
     sendBytes(*leds, pixels * leds->size);
-    if (doLatchDelay) _delay_us(ResetMicroseconds);
+    if (doLatchDelay) Latch::template sent<ResetMicroseconds>();
   }
   template <bool doLatchDelay = true>
   inline static void setLEDs(RGBW const *leds, u2 pixels) {
     sendBytes(*leds, pixels * leds->size);
-    if (doLatchDelay) _delay_us(ResetMicroseconds);
+    if (doLatchDelay) Latch::template sent<ResetMicroseconds>();
+  }
+
+  /**
+   * @brief Send pixels dimmed by `brightness`, and optionally through a gamma table, without changing `leds`
+   *
+   * Each byte is scaled as it's loaded, in the low time after the byte before it. That makes those low times a few
+   * cycles longer (`mul` and friends, plus `lpm` with a table), which WS2812 doesn't mind. No second buffer needed.
+   *
+   * @param brightness 255 is full, 0 is off
+   * @param gamma 256 bytes in flash (`PROGMEM`), looked up after scaling
+   */
+  template <bool doLatchDelay = true>
+  inline static void setLEDs(RGB const *leds, u2 pixels, u1 brightness) {
+    sendScaled(*leds, pixels * leds->size, brightness);
+    if (doLatchDelay) Latch::template sent<ResetMicroseconds>();
+  }
+  template <bool doLatchDelay = true>
+  inline static void setLEDs(RGB const *leds, u2 pixels, u1 brightness, u1 const *gamma) {
+    sendScaled(*leds, pixels * leds->size, brightness, gamma);
+    if (doLatchDelay) Latch::template sent<ResetMicroseconds>();
+  }
+  template <bool doLatchDelay = true>
+  inline static void setLEDs(RGBW const *leds, u2 pixels, u1 brightness) {
+    sendScaled(*leds, pixels * leds->size, brightness);
+    if (doLatchDelay) Latch::template sent<ResetMicroseconds>();
+  }
+  template <bool doLatchDelay = true>
+  inline static void setLEDs(RGBW const *leds, u2 pixels, u1 brightness, u1 const *gamma) {
+    sendScaled(*leds, pixels * leds->size, brightness, gamma);
+    if (doLatchDelay) Latch::template sent<ResetMicroseconds>();
+  }
+
+  /**
+   * @brief Send pixels stored as palette indices, looking up their colors while sending
+   *
+   * One byte per pixel, or half that with 4 bit indices, instead of 3 or 4. Each lookup adds a few more cycles to the
+   * low time after each byte, like `setLEDs()` with a brightness.
+   *
+   * @tparam IndexBits 8, or 4 for two pixels per byte, high nibble first
+   * @param indices `WS2812Pixels::PaletteExpander<Pixel, IndexBits>::indexBytes(pixels)` bytes
+   * @param palette RGB or RGBW colors, in RAM. 256 entries, or 16 with 4 bit indices, at most.
+   */
+  template <u1 IndexBits = 8, bool doLatchDelay = true, typename Pixel>
+  inline static void setLEDsIndexed(u1 const *indices, u2 pixels, Pixel const *palette) {
+    sendBytes(indices, pixels * Pixel::size, WS2812Pixels::PaletteExpander<Pixel, IndexBits>(indices, palette));
+    if (doLatchDelay) Latch::template sent<ResetMicroseconds>();
+  }
+
+  /**
+   * @brief Send pixels straight from flash, with no copy in RAM
+   *
+   * Each byte is read with `lpm Z+`, one cycle more than from RAM, in the low time after the byte before it.
+   *
+   * @param leds In flash (`PROGMEM`), below 64KB
+   */
+  template <bool doLatchDelay = true>
+  inline static void setLEDsFromFlash(RGB const *leds, u2 pixels) {
+    sendBytes(*leds, pixels * leds->size, FlashReader(leds));
+    if (doLatchDelay) Latch::template sent<ResetMicroseconds>();
+  }
+  template <bool doLatchDelay = true>
+  inline static void setLEDsFromFlash(RGBW const *leds, u2 pixels) {
+    sendBytes(*leds, pixels * leds->size, FlashReader(leds));
+    if (doLatchDelay) Latch::template sent<ResetMicroseconds>();
+  }
+
+  /**
+   * @brief Send pixels made by a function as they're sent, with no frame buffer
+   *
+   * `generate` runs in the low time after each pixel's last byte, so that low time is however long it takes. Since
+   * that can't be known at compile time, it has to be given: measure it with `CycleCount::measure()` and round up. It's
+   * checked against `ResetMicroseconds` the same way the rest of the low time is.
+   *
+   * ```C++
+   * LEDs::setLEDsGenerated<60>([](u2 i) { return LEDs::RGB(i, 0, 255 - i); }, 256);
+   * ```
+   *
+   * @tparam MaxGeneratorCycles The most cycles `generate` can take, including the call if it isn't inlined
+   * @tparam Pixel RGB or RGBW
+   * @param generate Called as `Pixel generate(u2 index)` for each pixel, in order
+   */
+  template <unsigned MaxGeneratorCycles, typename Pixel = RGB, bool doLatchDelay = true, typename Generator>
+  inline static void setLEDsGenerated(Generator &&generate, u2 pixels) {
+    static_assert(Parent::PulseMath::realLowMicrosecondsMaxWithISR(MaxISRMicroseconds) +
+                          MaxGeneratorCycles * 1e6 / F_CPU <
+                      ResetMicroseconds / 2,
+                  "Generator is too slow. The low time it adds could be considered a \"reset\".");
+
+    // Only counted along by `send()`. Never read.
+    u1 const *const none = nullptr;
+
+    sendBytes(none, pixels * Pixel::size, WS2812Pixels::GeneratedPixels<Pixel, Generator>(generate));
+    if (doLatchDelay) Latch::template sent<ResetMicroseconds>();
+  }
+
+#ifdef __AVR_HAVE_ELPM__
+  /**
+   * @brief Send pixels straight from anywhere in flash, with `elpm Z+`. Leaves RAMPZ set.
+   *
+   * @tparam Pixel RGB or RGBW
+   * @param address From `pgm_get_far_address()`
+   */
+  template <typename Pixel = RGB, bool doLatchDelay = true>
+  inline static void setLEDsFromFarFlash(u4 address, u2 pixels) {
+    sendBytes((u1 const *)u2(address), pixels * Pixel::size, FarFlashReader(address));
+    if (doLatchDelay) Latch::template sent<ResetMicroseconds>();
   }
+#endif
 };
 
 }; // namespace AVR
\ No newline at end of file
@@ -0,0 +1,166 @@
+#pragma once
+
+/**
+ * @brief Integer color math for WS2812 pixels: HSV to RGB, and temporal dithering
+ * @file WS2812Color.hpp
+ *
+ * No `float` and no division, so it's cheap enough to run per pixel, even from a `setLEDsGenerated()` generator.
+ *
+ * Hue is 0 to `HueMax` - 1 around the whole circle. The high byte is which sixth of the circle (red to yellow, yellow
+ * to green, ...) and the low byte is how far through it, so neither needs dividing out.
+ *
+ * `Dither` keeps 16 bits per channel and sends 8, carrying what's left over to the next frame. Refreshing fast
+ * enough, the eye averages the frames into the 16 bit color. That makes slow fades near black smooth instead of
+ * stepping through the few lowest 8 bit values.
+ *
+ * Plain C++ with no hardware access, so it can be checked on a PC too.
+ *
+ * Usage:
+ *
+ * ```C++
+ * #include <AVR++/WS2812Color.hpp>
+ *
+ * using namespace AVR;
+ *
+ * WS2812Color::Dither<LEDs::RGB, 60> fade;
+ *
+ * // A rainbow
+ * for (u2 i = 0; i < 60; i++)
+ *   fade.set(i, WS2812Color::hsv(i * (WS2812Color::HueMax / 60), 255, 255));
+ *
+ * while (true) {
+ *   LEDs::setLEDsGenerated<100>(fade, 60);
+ * }
+ * ```
+ */
+
+#include "WS2812Pixels.hpp"
+#include "basicTypes.hpp"
+
+namespace AVR {
+namespace WS2812Color {
+using namespace Basic;
+using WS2812Pixels::RGB;
+using WS2812Pixels::RGBW;
+
+constexpr u2 HueMax = 6 * 256;
+
+/**
+ * @param hue 0 to `HueMax` - 1. Red at 0, green at 512, blue at 1024.
+ * @param saturation 0 is white, 255 is fully colored
+ * @param value 0 is off, 255 is full
+ */
+constexpr RGB hsv(u2 hue, u1 saturation, u1 value) {
+  using WS2812Pixels::scale;
+
+  u1 const sector = hue >> 8;
+  u1 const rising = hue;
+
+  // Lowest channel, falling channel, rising channel
+  u1 const p = scale(value, 255 - saturation);
+  u1 const q = scale(value, 255 - scale(saturation, rising));
+  u1 const t = scale(value, 255 - scale(saturation, 255 - rising));
+
+  switch (sector) {
+  case 0:
+    return RGB(value, t, p);
+  case 1:
+    return RGB(q, value, p);
+  case 2:
+    return RGB(p, value, t);
+  case 3:
+    return RGB(p, q, value);
+  case 4:
+    return RGB(t, p, value);
+  default:
+    return RGB(value, p, q);
+  }
+}
+
+/**
+ * @brief Move the white common to all three channels into the W channel
+ */
+constexpr RGBW toRGBW(RGB c) {
+  u1 const w = c.r < c.g ? (c.r < c.b ? c.r : c.b) : (c.g < c.b ? c.g : c.b);
+  return RGBW(c.r - w, c.g - w, c.b - w, w);
+}
+
+/**
+ * @brief 16 bits per channel in, 8 bit frames out, with the error carried to the next frame
+ *
+ * A generator for `setLEDsGenerated()`. Every call makes the next frame of one pixel. RAM is 3 bytes per channel.
+ *
+ * @tparam Pixel RGB or RGBW
+ * @tparam Pixels How many pixels
+ */
+template <typename Pixel, u2 Pixels>
+class Dither {
+  // In the byte order of `Pixel`
+  u2 target[Pixels][Pixel::size];
+  u1 error[Pixels][Pixel::size];
+
+public:
+  constexpr Dither() : target{}, error{} {}
+
+  /**
+   * @param channels In the byte order of `Pixel`: g, r, b (, w). 0xffff is full.
+   */
+  inline void set(u2 index, u2 const (&channels)[Pixel::size]) {
+    for (u1 c = 0; c < Pixel::size; c++)
+      target[index][c] = channels[c];
+  }
+
+  /**
+   * @brief Set an 8 bit color. Still dithered, but only changes when the color does.
+   */
+  inline void set(u2 index, Pixel color) {
+    for (u1 c = 0; c < Pixel::size; c++)
+      target[index][c] = color.data()[c] << 8 | color.data()[c];
+  }
+
+  /**
+   * @brief Set a color scaled by a 16 bit brightness, 0xffff being full, to fade by less than one 8 bit step at a time
+   */
+  inline void set(u2 index, Pixel color, u2 brightness) {
+    for (u1 c = 0; c < Pixel::size; c++) {
+      u2 const full = color.data()[c] << 8 | color.data()[c];
+      target[index][c] = (u4(full) * brightness + full) >> 16;
+    }
+  }
+
+  /**
+   * @brief The next frame of pixel `index`
+   */
+  inline Pixel operator()(u2 index) {
+    Pixel out;
+    u1 *const bytes = (u1 *)&out;
+
+    for (u1 c = 0; c < Pixel::size; c++) {
+      u3 const sum = u3(target[index][c]) + error[index][c];
+
+      // Only full white can carry out. Just leave it full.
+      bytes[c] = sum > 0xffff ? 0xff : u1(sum >> 8);
+      error[index][c] = sum > 0xffff ? 0 : u1(sum);
+    }
+
+    return out;
+  }
+};
+
+namespace SelfTest {
+constexpr bool same(RGB a, RGB b) { return a.r == b.r && a.g == b.g && a.b == b.b; }
+
+static_assert(same(hsv(0, 255, 255), RGB(255, 0, 0)), "Red");
+static_assert(same(hsv(512, 255, 255), RGB(0, 255, 0)), "Green");
+static_assert(same(hsv(1024, 255, 255), RGB(0, 0, 255)), "Blue");
+static_assert(same(hsv(256, 255, 255), RGB(255, 255, 0)), "Yellow");
+static_assert(same(hsv(128, 255, 255), RGB(255, 128, 0)), "Orange, halfway to yellow");
+static_assert(same(hsv(1280, 255, 255), RGB(255, 0, 255)), "Magenta");
+static_assert(same(hsv(HueMax - 1, 255, 255), RGB(255, 0, 0)), "Back to red");
+static_assert(same(hsv(700, 0, 200), RGB(200, 200, 200)), "No saturation is gray");
+static_assert(same(hsv(700, 255, 0), RGB(0, 0, 0)), "No value is off");
+static_assert(toRGBW(RGB(200, 100, 50)).w == 50 && toRGBW(RGB(200, 100, 50)).r == 150, "White pulled out");
+} // namespace SelfTest
+
+} // namespace WS2812Color
+} // namespace AVR
@@ -0,0 +1,93 @@
+#pragma once
+
+/**
+ * @brief How `WS2812` waits out the reset (latch) time after sending
+ * @file WS2812Latch.hpp
+ *
+ * The strip only latches once the line has been low for `ResetMicroseconds`. `Delay` waits that out right after
+ * sending, which is 300us of nothing per frame. `Deferred` notes when sending finished and returns right away. It only
+ * waits, if the time hasn't passed yet, at the start of the next send.
+ *
+ * `Deferred` takes its time from any free running timer the application already has, like BootloaderDeadline:
+ *
+ * ```C++
+ * // Timer1 running with a /8 prescaler
+ * struct Clock {
+ *   static constexpr u4 Hz = F_CPU / 8;
+ *   static inline u2 now() { return TCNT1; }
+ * };
+ *
+ * using LEDs = AVR::WS2812<AVR::Ports::B, 0, false, true, 300, false, false, AVR::InterruptHandling::None, 0, 3,
+ *                          AVR::WS2812Latch::Deferred<Clock>>;
+ * ```
+ */
+
+#include "basicTypes.hpp"
+#include <util/delay.h>
+
+namespace AVR {
+namespace WS2812Latch {
+using namespace Basic;
+
+/**
+ * @brief Busy wait right after sending
+ */
+struct Delay {
+  template <unsigned ResetMicroseconds>
+  inline static void sent() {
+    _delay_us(ResetMicroseconds);
+  }
+
+  template <unsigned ResetMicroseconds>
+  inline static void wait() {}
+};
+
+/**
+ * @brief Remember when sending finished and only wait, if needed, before sending again
+ *
+ * Strips sharing a `Clock` share the time too, so each one waits for whichever sent last. That can only wait longer
+ * than needed, never too short.
+ *
+ * Elapsed time is counted in 16 bits, so if the next send comes a multiple of 65536 ticks later, give or take the reset
+ * time, it waits once more than it had to.
+ *
+ * @tparam Clock With `static u2 now()`, a free running count, and `static constexpr u4 Hz`, how fast it counts
+ */
+template <typename Clock>
+class Deferred {
+  static u2 finished;
+  static bool pending;
+
+  template <unsigned ResetMicroseconds>
+  static constexpr u2 ticks() {
+    static_assert(ResetMicroseconds * double(Clock::Hz) / 1e6 < 0x8000, "Clock is too fast for this ResetMicroseconds");
+    // Truncating can lose most of a tick, and the tick `finished` was read in was already partly gone
+    return u2(ResetMicroseconds * double(Clock::Hz) / 1e6) + 2;
+  }
+
+public:
+  template <unsigned ResetMicroseconds>
+  inline static void sent() {
+    finished = Clock::now();
+    pending = true;
+  }
+
+  template <unsigned ResetMicroseconds>
+  inline static void wait() {
+    if (!pending) return;
+
+    while (u2(Clock::now() - finished) < ticks<ResetMicroseconds>())
+      ;
+
+    pending = false;
+  }
+};
+
+template <typename Clock>
+u2 Deferred<Clock>::finished;
+
+template <typename Clock>
+bool Deferred<Clock>::pending = false;
+
+} // namespace WS2812Latch
+} // namespace AVR
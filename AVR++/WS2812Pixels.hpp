@@ -0,0 +1,140 @@
+#pragma once
+
+/**
+ * @brief The pixel types sent to WS2812 (and related) LEDs
+ * @file WS2812Pixels.hpp
+ *
+ * Shared by every WS2812 backend so they all take the same `setLEDs()` arguments. Also what `WS2812` uses to build
+ * those bytes while sending.
+ */
+
+#include "basicTypes.hpp"
+
+namespace AVR {
+namespace WS2812Pixels {
+using namespace Basic;
+
+struct RGB {
+  // This order matches the order of the WS2812 protocol
+
+  u1 g;
+  u1 r;
+  u1 b;
+  constexpr RGB() : g(0), r(0), b(0) {}
+  constexpr RGB(u1 w) : g(w), r(w), b(w) {}
+  constexpr RGB(u1 r, u1 g, u1 b) : g(g), r(r), b(b) {}
+
+  inline u1 const *data() const { return (u1 const *)this; }
+  inline operator u1 const *() const { return data(); }
+  static constexpr u1 size = 3;
+};
+
+static_assert(sizeof(RGB) == RGB::size, "RGB must be packed");
+
+struct RGBW {
+  // This order matches the order of the WS2812 protocol
+
+  u1 g;
+  u1 r;
+  u1 b;
+  u1 w;
+  constexpr RGBW() : g(0), r(0), b(0), w(0) {}
+  constexpr RGBW(u1 w) : g(0), r(0), b(0), w(w) {}
+  constexpr RGBW(u1 r, u1 g, u1 b, u1 w = 0) : g(g), r(r), b(b), w(w) {}
+
+  inline u1 const *data() const { return (u1 const *)this; }
+  inline operator u1 const *() const { return data(); }
+  static constexpr u1 size = 4;
+};
+
+static_assert(sizeof(RGBW) == RGBW::size, "RGBW must be packed");
+
+/**
+ * @brief Scale one color byte by a brightness, where 255 is full and 0 is off
+ *
+ * `mul`, then an add so 255 leaves `value` as it is.
+ */
+constexpr u1 scale(u1 value, u1 brightness) { return (u2(value) * brightness + value) >> 8; }
+
+static_assert(scale(200, 255) == 200, "Full brightness should not change anything");
+static_assert(scale(200, 0) == 0, "Zero brightness should be off");
+static_assert(scale(200, 128) == 100, "Half brightness should be half");
+
+/**
+ * @brief Turns palette indices into the bytes of each pixel, one byte per call, while sending
+ *
+ * For `PulsedOutput::send(data, bytes, load)`, which has to be told `Pixel::size` bytes per pixel. The pointer it
+ * passes is ignored.
+ *
+ * Each pixel's palette entry is found once, on its first byte. The others are just the next byte of that entry.
+ *
+ * @tparam Pixel RGB or RGBW
+ * @tparam IndexBits 8, or 4 for two pixels per byte, high nibble first
+ */
+template <typename Pixel, u1 IndexBits>
+struct PaletteExpander {
+  static_assert(IndexBits == 8 || IndexBits == 4, "Palette indices must be 8 or 4 bits");
+
+  u1 const *index;
+  Pixel const *palette;
+  u1 const *entry = nullptr;
+  u1 channel = 0;
+  bool lowNibble = false;
+
+  PaletteExpander(u1 const *indices, Pixel const *palette) : index(indices), palette(palette) {}
+
+  /**
+   * @return How many bytes of indices `pixels` takes
+   */
+  static constexpr u2 indexBytes(u2 pixels) { return IndexBits == 8 ? pixels : (pixels + 1) / 2; }
+
+  inline u1 operator()(u1 const *) {
+    if (!channel) {
+      u1 i = *index;
+      if (IndexBits == 4) i = lowNibble ? i & 0xf : i >> 4;
+      entry = palette[i];
+    }
+
+    u1 const value = entry[channel];
+
+    if (++channel == Pixel::size) {
+      channel = 0;
+
+      if (IndexBits == 4) lowNibble = !lowNibble;
+      if (IndexBits == 8 || !lowNibble) index++;
+    }
+
+    return value;
+  }
+};
+
+/**
+ * @brief Makes each pixel with a function, on its first byte, while sending
+ *
+ * For `PulsedOutput::send(data, bytes, load)` like `PaletteExpander`. Nothing is stored but the current pixel.
+ *
+ * @tparam Pixel RGB or RGBW
+ * @tparam Generator Called as `Pixel generate(u2 index)`, once per pixel, in order
+ */
+template <typename Pixel, typename Generator>
+struct GeneratedPixels {
+  Generator &generate;
+  Pixel pixel;
+  u2 index = 0;
+  u1 channel = 0;
+
+  GeneratedPixels(Generator &generate) : generate(generate) {}
+
+  inline u1 operator()(u1 const *) {
+    if (!channel) pixel = generate(index++);
+
+    u1 const value = pixel.data()[channel];
+
+    if (++channel == Pixel::size) channel = 0;
+
+    return value;
+  }
+};
+
+} // namespace WS2812Pixels
+} // namespace AVR
@@ -0,0 +1,56 @@
+#pragma once
+
+/**
+ * @file WS2812USART.cpp
+ * @author Cameron Tacklind <cameron@tacklind.com>
+ * @brief The implementation of the WS2812USART class
+ * @note This file is part of the AVR++ library.
+ *
+ * @see The comments in WS2812USART.hpp for more information on the internal workings of this implementation.
+ */
+
+#include "WS2812USART.hpp"
+
+template <unsigned ResetMicroseconds>
+void AVR::WS2812USART<ResetMicroseconds>::init() {
+#ifdef __AVR_ATmega32U4__
+  // TXD1 low while the transmitter is off. XCK1 must be an output for Master mode.
+  PORTD &= ~(1 << 3);
+  DDRD |= 1 << 3 | 1 << 5;
+#else
+  // TODO: Support more chips here
+#error "Unsupported MCU"
+#endif
+
+  // The datasheet says the baud rate must be 0 while setting the mode and enabling the transmitter
+  Serial::setBRR(0);
+
+  // Master SPI Mode, MSB first, sample on the leading edge. The clock on XCK1 isn't used.
+  UCSR1C = 1 << UMSEL11 | 1 << UMSEL10;
+  Serial::enableTx();
+
+  Serial::setBRR(EncodeMath::ubrr);
+}
+
+template <unsigned ResetMicroseconds>
+void AVR::WS2812USART<ResetMicroseconds>::sendBytes(u1 const *bytes, u2 length) {
+  if (!length) return;
+
+  do {
+    u1 b = *bytes++;
+
+    for (u1 i = 4; i; i--) {
+      while (!Serial::dataRegisterEmpty())
+        ;
+
+      Serial::setDataRegister(Encoding::encode(b));
+      b <<= 2;
+    }
+  } while (--length);
+
+  // The last byte has started shifting out once the Data Register is empty again. Then it takes one SPI byte.
+  while (!Serial::dataRegisterEmpty())
+    ;
+
+  _delay_us(EncodeMath::realByteMicroseconds);
+}
@@ -0,0 +1,170 @@
+#pragma once
+
+/**
+ * @brief WS2812 output from the USART in Master SPI Mode (MSPIM)
+ * @file WS2812USART.hpp
+ * @author Cameron Tacklind <cameron@tacklind.com>
+ *
+ * `WS2812` bit-bangs every bit with interrupts off for the whole strip. This backend lets USART1 shift the bits out
+ * instead. Each LED bit is 4 SPI bits, a pulse made of 1s followed by 0s:
+ *
+ *     "0" = 1000     "1" = 1100     (16MHz, 375ns SPI bits, 1.5us per LED bit)
+ *
+ * Slower clocks use 1100 and 1110 with shorter SPI bits. Either way, each SPI byte is two whole LED bits and ends low.
+ * The transmitter can run dry between SPI bytes without harm: the line just stays low longer, which WS2812s ignore
+ * well short of the reset time. Only a stall inside a high pulse would corrupt the data, and that can't happen.
+ *
+ * `setLEDs()` polls the Data Register Empty flag and loads each SPI byte as soon as there's room. It still blocks, but
+ * interrupts stay enabled. Any that run, or a loop slower than `EncodeMath::cyclesPerByte`, only stretch a low time.
+ *
+ * There's no interrupt driven version. Entering and leaving an interrupt alone takes most of an SPI byte at 16MHz, so
+ * it would be pending again by its `reti`, leave the main loop almost nothing, and refresh slower than polling.
+ *
+ * Every encoded LED bit ends with a 0, so the line is low after the last byte for the latch.
+ *
+ * On the ATmega32U4, data is on TXD1 (PD3). XCK1 (PD5) has to be an output for Master mode, so it can't be used for
+ * anything else.
+ *
+ * Usage:
+ *
+ * ```main.cpp
+ * #include <AVR++/WS2812USART.cpp> // Yes, a cpp file
+ *
+ * using LEDs = AVR::WS2812USART<>;
+ * template class AVR::WS2812USART<>;
+ *
+ * LEDs::RGB strip[300];
+ *
+ * int main() {
+ *   LEDs::init();
+ *   sei();
+ *
+ *   while (true) {
+ *     // Blocks, but other interrupts keep running
+ *     LEDs::setLEDs(strip, 300);
+ *   }
+ * }
+ * ```
+ */
+
+#include "Const.hpp"
+#include "USART.hpp"
+#include "WS2812Pixels.hpp"
+#include "basicTypes.hpp"
+#include <util/delay.h>
+
+namespace AVR {
+using namespace Basic;
+
+namespace WS2812Encoding {
+
+/**
+ * @brief Spelling out each LED bit as 4 SPI bits, two LED bits to an SPI byte
+ *
+ * Plain C++ with no hardware access, so it can be checked on a PC too.
+ *
+ * @tparam HighBits0 SPI bits at the start of a "0" that are 1s. A "1" has one more. 1 or 2.
+ */
+template <u1 HighBits0>
+struct Pair {
+  static_assert(HighBits0 == 1 || HighBits0 == 2, "Every LED bit needs to start high and end low");
+
+  static constexpr u1 code(bool one) {
+    u1 const high = HighBits0 + one;
+    return u1(((1 << high) - 1) << (4 - high));
+  }
+
+  static constexpr u1 zeros = code(false) << 4 | code(false);
+  static constexpr u1 firstOne = (code(true) ^ code(false)) << 4;
+  static constexpr u1 secondOne = code(true) ^ code(false);
+
+  /**
+   * @brief The 2 most significant bits of `byte` as one SPI byte. Bit tests, so no shifting at run time.
+   */
+  inline static constexpr u1 encode(u1 byte) {
+    u1 out = zeros;
+    if (byte & 0x80) out |= firstOne;
+    if (byte & 0x40) out |= secondOne;
+    return out;
+  }
+};
+
+namespace SelfTest {
+static_assert(Pair<1>::encode(0x00) == 0b10001000, "Every \"0\" is 1000");
+static_assert(Pair<1>::encode(0xff) == 0b11001100, "Every \"1\" is 1100");
+static_assert(Pair<1>::encode(0x80) == 0b11001000, "First LED bit in the high nibble");
+static_assert(Pair<1>::encode(0x7f) == 0b10001100, "Second LED bit in the low nibble");
+static_assert(Pair<2>::encode(0xbf) == 0b11101100, "A \"1\" is 1110 and a \"0\" is 1100");
+} // namespace SelfTest
+
+} // namespace WS2812Encoding
+
+/**
+ * @tparam ResetMicroseconds How long to hold the line low after sending, to latch, with `setLEDs()` (300)
+ */
+template <unsigned ResetMicroseconds = 300>
+class WS2812USART {
+public:
+  using RGB = WS2812Pixels::RGB;
+  using RGBW = WS2812Pixels::RGBW;
+
+  struct EncodeMath {
+    // 2 * (UBRR + 1) CPU cycles per SPI bit, as close as we can get to a "0" being `highBits0` of them
+    static constexpr u2 ubrrFor(u1 highBits0) {
+      return Const::max(1, Const::round(F_CPU * 400e-9 / highBits0 / 2)) - 1;
+    }
+    static constexpr double spiBitNanos(u1 highBits0) { return 2 * (ubrrFor(highBits0) + 1) * 1e9 / F_CPU; }
+
+    // Same tolerances as WS2812.cpp: 400ns and 800ns, +/- 150ns
+    static constexpr bool within(double high, double nominal) { return high >= nominal - 150 && high <= nominal + 150; }
+    static constexpr bool fits(u1 highBits0) {
+      return within(highBits0 * spiBitNanos(highBits0), 400) && within((highBits0 + 1) * spiBitNanos(highBits0), 800);
+    }
+
+    // Longer SPI bits leave more time to load each SPI byte
+    static constexpr u1 highBits0 = fits(1) ? 1 : 2;
+
+    static_assert(fits(highBits0), "WS2812 timing can't be made with the USART at this F_CPU");
+
+    using Encoding = WS2812Encoding::Pair<highBits0>;
+
+    static constexpr u2 ubrr = ubrrFor(highBits0);
+
+    static constexpr unsigned cyclesPerByte = 8 * 2 * (ubrr + 1);
+
+    // Values that will actually be used. For developer inspection with modern editor. Not used in code.
+
+    static constexpr auto realHighNanosecondsShort = highBits0 * spiBitNanos(highBits0);
+    static constexpr auto realHighNanosecondsLong = (highBits0 + 1) * spiBitNanos(highBits0);
+    static constexpr auto realBitNanoseconds = 4 * spiBitNanos(highBits0);
+    static constexpr auto realByteMicroseconds = cyclesPerByte * 1e6 / F_CPU;
+  };
+
+protected:
+  using Serial = USART<0xC8>;
+  using Encoding = typename EncodeMath::Encoding;
+
+  /**
+   * @brief Send bytes and wait for the last one to be completely shifted out
+   */
+  static void sendBytes(u1 const *bytes, u2 length);
+
+public:
+  /**
+   * @brief Set up USART1 in Master SPI Mode and its pins
+   */
+  static void init();
+
+  template <bool doLatchDelay = true>
+  inline static void setLEDs(RGB const *leds, u2 pixels) {
+    sendBytes(*leds, pixels * leds->size);
+    if (doLatchDelay) _delay_us(ResetMicroseconds);
+  }
+  template <bool doLatchDelay = true>
+  inline static void setLEDs(RGBW const *leds, u2 pixels) {
+    sendBytes(*leds, pixels * leds->size);
+    if (doLatchDelay) _delay_us(ResetMicroseconds);
+  }
+};
+
+}; // namespace AVR
@@ -6,13 +6,22 @@ namespace Basic {
 
 typedef uint8_t u1;
 typedef uint16_t u2;
+#ifdef __AVR__
 typedef __uint24 u3;
+#else
+// Host side tools, like simulators
+typedef uint32_t u3;
+#endif
 typedef uint32_t u4;
 typedef uint64_t u8;
 
 typedef int8_t s1;
 typedef int16_t s2;
+#ifdef __AVR__
 typedef __int24 s3;
+#else
+typedef int32_t s3;
+#endif
 typedef int32_t s4;
 typedef int64_t s8;
 
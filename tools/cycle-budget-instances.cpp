@@ -0,0 +1,33 @@
+/**
+ * @brief Instantiates every timed loop in AVR++ for tools/cycle-budget.sh
+ * @file cycle-budget-instances.cpp
+ *
+ * Only compiled to assembly, never linked. `PulsedOutput` is checked through `WS2812` and `DShot`, which send whole
+ * byte arrays, so the low time after each byte is measured across the outer loop.
+ *
+ * DSHOT600 and faster don't fit the bit time tolerance at 16MHz, so they aren't here.
+ */
+
+#include <AVR++/BDShot.cpp>
+#include <AVR++/BDShotGroup.cpp>
+#include <AVR++/ParallelPulsedOutput.cpp>
+#include <AVR++/WS2812.cpp>
+
+using namespace AVR;
+
+// SendGenerator::Tight
+template class AVR::WS2812<Ports::B, 0>;
+// BalanceRecoveryTimes
+template class AVR::WS2812<Ports::B, 1, true>;
+// Each InterruptHandling
+template class AVR::WS2812<Ports::B, 2, false, true, 300, false, false, InterruptHandling::Bit, 5>;
+template class AVR::WS2812<Ports::B, 3, false, true, 300, false, false, InterruptHandling::Byte, 5>;
+template class AVR::WS2812<Ports::B, 4, false, true, 300, false, false, InterruptHandling::Block, 5>;
+
+// SendGenerator::Overlapped
+template class AVR::DShot::DShot<Ports::C, 6, DShot::Speeds::DSHOT150>;
+// Balanced and inverted, with the receiver
+template class AVR::DShot::BDShot<Ports::C, 7, DShot::Speeds::DSHOT300>;
+
+template class AVR::ParallelPulsedOutput<Ports::D, 0x0f, 400>;
+template class AVR::DShot::BDShotGroup<Ports::F, 0xf0, DShot::Speeds::DSHOT300>;
@@ -0,0 +1,279 @@
+#!/usr/bin/env python3
+"""
+Check the hand counted cycle budgets in AVR++ against what the compiler actually generated.
+
+The timing math (`PulseMath` and friends) assumes a certain number of cycles between the writes that make each pulse.
+Those numbers were counted by hand from the generated assembly and silently go stale when the code, compiler, or flags
+change. The timed code marks those regions with assembler comments:
+
+    ; CycleBudget begin <region> <expected> [<expected>...]
+    ; CycleBudget end <region>
+
+Every path from a `begin` to the first `end` of the same region is walked and its cycles added up. Every path has to
+take one of the expected values. Delays from `nopCycles()` are trusted and counted as the number of cycles they were
+asked for.
+
+Paths that leave the timed code, like after the last bit of a loop, aren't counted if they pass:
+
+    ; CycleBudget stop <region>
+
+A path that comes back around to its own `begin` is a spin loop trying again and isn't counted either. To check the
+period of such a loop instead, mark its top with:
+
+    ; CycleBudget loop <region> <expected> [<expected>...]
+
+Every other way out of a region is a problem: a `ret`, `reti`, or indirect jump, the end of the function, a call, or a
+loop that never reaches `end`. Those paths would otherwise go unchecked.
+
+Cycles are counted from the start of the first instruction after `begin` to the start of the first instruction after
+`end`. Put `begin` right before the write that starts a pulse and `end` right before the write that ends it.
+
+The comments only survive in the compiler's assembly output, not in objects, so this reads `-S` output:
+
+    avr-g++ -mmcu=atmega32u4 -DF_CPU=16000000UL -Os -std=gnu++17 -I path/to -S instances.cpp -o instances.s
+    tools/cycle-budget.py instances.s
+
+where `instances.cpp` explicitly instantiates whatever should be checked. `tools/cycle-budget.sh` does both for
+`tools/cycle-budget-instances.cpp`, which covers the timed loops in this library.
+
+Exits non-zero if any region doesn't match or has no complete path.
+"""
+
+import re
+import sys
+
+# Classic AVR core (AVRe/AVRe+, like the ATmega32U4). Everything not listed takes 1 cycle.
+CYCLES = {
+    "adiw": 2, "sbiw": 2, "mul": 2, "muls": 2, "mulsu": 2, "fmul": 2, "fmuls": 2, "fmulsu": 2,
+    "ld": 2, "ldd": 2, "lds": 2, "st": 2, "std": 2, "sts": 2, "push": 2, "pop": 2,
+    "lpm": 3, "elpm": 3, "spm": 4,
+    "sbi": 2, "cbi": 2,
+    "rjmp": 2, "ijmp": 2, "eijmp": 2, "jmp": 3,
+    "rcall": 3, "icall": 3, "eicall": 4, "call": 4, "ret": 4, "reti": 4,
+}
+
+# Two word instructions, for skips
+TWO_WORDS = {"lds", "sts", "jmp", "call"}
+
+BRANCHES = {
+    "brcs", "brcc", "brlo", "brsh", "breq", "brne", "brmi", "brpl", "brge", "brlt",
+    "brhs", "brhc", "brts", "brtc", "brvs", "brvc", "brie", "brid", "brbs", "brbc",
+}
+SKIPS = {"cpse", "sbrc", "sbrs", "sbic", "sbis"}
+JUMPS = {"rjmp", "jmp"}
+DEAD_ENDS = {"ret", "reti", "ijmp", "eijmp"}
+CALLS = {"rcall", "call", "icall", "eicall"}
+
+BEGIN = re.compile(r";\s*CycleBudget (begin|loop) (\S+)((?:\s+\d+)+)")
+END = re.compile(r";\s*CycleBudget end (\S+)")
+STOP = re.compile(r";\s*CycleBudget stop (\S+)")
+DELAY = re.compile(r";\s*(__builtin_avr_delay_cycles|nopCycles)\((\d+)\)")
+DELAY_END = re.compile(r";\s*(__builtin_avr_delay_cycles|nopCycles) end")
+LABEL = re.compile(r"^([.\w$]+):")
+FUNCTION = re.compile(r"^\s*\.type\s+([^,]+),\s*@function")
+
+MAX_PATHS = 10000
+
+
+class Line:
+    def __init__(self, text):
+        self.text = text
+        self.comment = None
+        self.label = None
+        self.mnemonic = None
+        self.operands = []
+        self.directive = False
+
+        code = text.strip()
+        if code.startswith(";"):
+            self.comment = code
+            return
+
+        m = LABEL.match(code)
+        if m:
+            self.label = m.group(1)
+            code = code[m.end():].strip()
+
+        code = re.sub(r"/\*.*?\*/", "", code).split(";")[0].strip()
+        if not code:
+            return
+        if code.startswith("."):
+            self.directive = True
+            return
+
+        parts = code.split(None, 1)
+        self.mnemonic = parts[0].lower()
+        if len(parts) > 1:
+            self.operands = [o.strip() for o in parts[1].split(",")]
+
+
+def parse(path):
+    with open(path) as f:
+        return [Line(t) for t in f.read().splitlines()]
+
+
+def walk(lines, labels, start, region, loop):
+    """
+    @param loop Whether coming back to `start` completes a path, instead of trying again
+    @return (set of cycles for every complete path, list of problems)
+    """
+    found = set()
+    problems = []
+    paths = 0
+    # (index, cycles, indices already on this path)
+    stack = [(start, 0, frozenset())]
+
+    while stack:
+        i, cycles, seen = stack.pop()
+
+        while True:
+            if i >= len(lines):
+                problems.append("path runs off the end of the file")
+                break
+
+            line = lines[i]
+
+            if line.comment:
+                m = BEGIN.search(line.comment)
+                if m and m.group(2) == region and i == start - 1:
+                    if loop:
+                        found.add(cycles)
+                    break
+
+            if i in seen:
+                problems.append("path loops at line %d without reaching the end marker" % (i + 1))
+                break
+
+            seen = seen | {i}
+
+            if line.comment:
+                m = END.search(line.comment)
+                if m and m.group(1) == region:
+                    found.add(cycles)
+                    break
+
+                m = STOP.search(line.comment)
+                if m and m.group(1) == region:
+                    break
+
+                m = DELAY.search(line.comment)
+                if m:
+                    j = i + 1
+                    while j < len(lines) and not (lines[j].comment and DELAY_END.search(lines[j].comment)):
+                        j += 1
+                    if j == len(lines):
+                        problems.append("delay without an end marker at line %d" % (i + 1))
+                        break
+                    cycles += int(m.group(2))
+                    i = j + 1
+                    continue
+
+                i += 1
+                continue
+
+            if line.directive and line.text.strip().startswith(".size"):
+                problems.append("path reaches the end of the function at line %d" % (i + 1))
+                break
+
+            op = line.mnemonic
+            if not op:
+                i += 1
+                continue
+
+            if op in CALLS:
+                problems.append("call in region at line %d: %s" % (i + 1, line.text.strip()))
+                break
+
+            if op in DEAD_ENDS:
+                problems.append("path leaves the region at line %d: %s" % (i + 1, line.text.strip()))
+                break
+
+            if op in BRANCHES:
+                target = line.operands[-1]
+                if target not in labels:
+                    problems.append("unknown branch target at line %d: %s" % (i + 1, line.text.strip()))
+                    break
+                stack.append((labels[target], cycles + 2, seen))
+                cycles += 1
+                i += 1
+                continue
+
+            if op in SKIPS:
+                n = i + 1
+                while n < len(lines) and not lines[n].mnemonic:
+                    n += 1
+                skipped = 3 if n < len(lines) and lines[n].mnemonic in TWO_WORDS else 2
+                stack.append((n + 1, cycles + skipped, seen))
+                cycles += 1
+                i += 1
+                continue
+
+            if op in JUMPS:
+                target = line.operands[0]
+                cycles += CYCLES[op]
+                if target == ".":
+                    # rjmp . is a 2 cycle nop
+                    i += 1
+                    continue
+                if target not in labels:
+                    problems.append("unknown jump target at line %d: %s" % (i + 1, line.text.strip()))
+                    break
+                i = labels[target]
+                continue
+
+            cycles += CYCLES.get(op, 1)
+            i += 1
+
+        paths += 1
+        if paths > MAX_PATHS:
+            problems.append("too many paths")
+            break
+
+    return found, problems
+
+
+def check(path):
+    lines = parse(path)
+    labels = {l.label: i for i, l in enumerate(lines) if l.label}
+
+    failures = 0
+    function = "?"
+
+    print("%-40s %-28s %-16s %-16s %s" % ("function", "region", "expected", "measured", ""))
+
+    for i, line in enumerate(lines):
+        m = FUNCTION.match(line.text)
+        if m:
+            function = m.group(1)
+
+        m = line.comment and BEGIN.search(line.comment)
+        if not m:
+            continue
+
+        region = m.group(2)
+        expected = {int(v) for v in m.group(3).split()}
+        found, problems = walk(lines, labels, i + 1, region, m.group(1) == "loop")
+
+        ok = found and found <= expected and not problems
+        if not ok:
+            failures += 1
+
+        print("%-40s %-28s %-16s %-16s %s" % (function[:40], region, " ".join(map(str, sorted(expected))),
+                                              " ".join(map(str, sorted(found))) or "-", "ok" if ok else "FAIL"))
+        for p in dict.fromkeys(problems):
+            print("    " + p)
+
+    return failures
+
+
+def main(argv):
+    if len(argv) < 2:
+        print(__doc__)
+        return 2
+
+    failures = sum(check(path) for path in argv[1:])
+    return 1 if failures else 0
+
+
+if __name__ == "__main__":
+    sys.exit(main(sys.argv))
@@ -0,0 +1,27 @@
+#!/bin/sh
+# Compile tools/cycle-budget-instances.cpp to assembly and check every CycleBudget region in it.
+#
+# Usage: tools/cycle-budget.sh [F_CPU...]  (16000000)
+#
+# Needs avr-g++ on the PATH. MMCU, CXXFLAGS, and OUT (a directory for the .s files) can be overridden.
+
+set -e
+
+cd "$(dirname "$0")/.."
+
+MMCU=${MMCU:-atmega32u4}
+CXXFLAGS=${CXXFLAGS:--Os -std=gnu++17}
+OUT=${OUT:-$(mktemp -d)}
+
+[ $# -gt 0 ] || set -- 16000000
+
+status=0
+
+for f in "$@"; do
+  s="$OUT/cycle-budget-$MMCU-$f.s"
+  echo "== $MMCU $f Hz"
+  avr-g++ -mmcu="$MMCU" -DF_CPU="${f}UL" $CXXFLAGS -I. -S tools/cycle-budget-instances.cpp -o "$s"
+  tools/cycle-budget.py "$s" || status=1
+done
+
+exit $status
@@ -0,0 +1,63 @@
+/**
+ * @brief Known frames on PB0 for tools/pulse-timing.sh to run in simavr
+ * @file pulse-timing-firmware.cpp
+ *
+ * Sends the same frame a few times, then sleeps with interrupts off, which ends the simulation. simavr traces PB0 into
+ * pulse-timing.vcd in its working directory.
+ *
+ * Built with one of:
+ *
+ *     -DWS2812_STRICT=<0|1> -DFRAME=<bytes>              WS2812, StrictTiming or not
+ *     -DDSHOT_SPEED=<DSHOT300...> -DDSHOT_INVERTED=<0|1> -DDSHOT_VALUE=<value>
+ *
+ * Needs simavr's avr_mcu_section.h on the include path.
+ */
+
+#include <avr/interrupt.h>
+#include <avr/io.h>
+#include <avr/sleep.h>
+#include <simavr/avr/avr_mcu_section.h>
+#include <util/delay.h>
+
+#ifdef WS2812_STRICT
+#include <AVR++/WS2812.cpp>
+#else
+#include <AVR++/DShot.cpp>
+#endif
+
+AVR_MCU(F_CPU, "atmega32u4");
+AVR_MCU_VCD_FILE("pulse-timing.vcd", 1000);
+
+// AVR_MCU_VCD_SYMBOL() names its fields out of order, which C++ doesn't allow
+extern "C" const struct avr_mmcu_vcd_trace_t pulseTimingTrace[] _MMCU_ __attribute__((used)) = {
+    {AVR_MMCU_TAG_VCD_TRACE, sizeof(struct avr_mmcu_vcd_trace_t) - 2, 1 << 0, (void *)&PORTB, "PB0"},
+};
+
+static constexpr Basic::u1 frames = 3;
+
+int main() {
+#ifdef WS2812_STRICT
+  using LEDs = AVR::WS2812<AVR::Ports::B, 0, WS2812_STRICT>;
+  static Basic::u1 const frame[] = {FRAME};
+  static_assert(sizeof(frame) % sizeof(LEDs::RGB) == 0, "FRAME must be whole RGB pixels");
+
+  LEDs::init();
+
+  for (Basic::u1 i = frames; i; i--)
+    LEDs::setLEDs(reinterpret_cast<LEDs::RGB const *>(frame), sizeof(frame) / sizeof(LEDs::RGB));
+#else
+  using ESC = AVR::DShot::DShot<AVR::Ports::B, 0, AVR::DShot::Speeds::DSHOT_SPEED, DSHOT_INVERTED>;
+
+  ESC::init();
+  _delay_us(100);
+
+  for (Basic::u1 i = frames; i; i--) {
+    ESC::sendCommand(DSHOT_VALUE);
+    _delay_us(100);
+  }
+#endif
+
+  cli();
+  sleep_enable();
+  sleep_cpu();
+}
@@ -0,0 +1,244 @@
+#!/usr/bin/env python3
+"""
+Measure the pulses in a VCD trace of a pin and check them against the timing they're supposed to have.
+
+`PulseMath` says what `PulsedOutput`, `DShot`, `WS2812`, and `BDShotGroup` should put on the pin. This checks what a
+simulator (like simavr) or a logic analyzer that exports VCD actually saw:
+
+    tools/pulse-timing.py trace.vcd PB0 --high 400 800 --tolerance 150 --frame-gap 50
+
+With `--expect`, every frame has to be exactly those bytes, most significant bit first, and each high pulse is checked
+against the `--high` time of the bit it was meant to be, "0" then "1". That's how `tools/pulse-timing.sh` runs it on
+known frames. Without it, each high is matched to the closest `--high` time instead, which can't tell a "0" stretched
+into a "1" from a real "1", so only use that on traffic of unknown data.
+
+Each high has to be within `--tolerance` of its time. Lows inside a frame have to be at least `--low-min`. A low
+longer than `--frame-gap` microseconds ends a frame. Every value found is reported as a table so changes between builds
+are easy to spot:
+
+    what             expected  count      min      max  ok
+    high            400 +-150     96    375.0    375.0  ok
+    high            800 +-150    144    750.0    750.0  ok
+    low                >= 200    239    437.5    875.0  ok
+    frame                   -      1  300.000  300.000  us, 240 bits
+
+Times are in nanoseconds, except frames, which are in microseconds.
+
+Some starting points, from the nominal timing of each protocol:
+
+    WS2812        --high 400 800 --tolerance 150 --frame-gap 50
+    DShot150      --high 2500 5000 --bit 6667 --frame-gap 20
+    DShot300      --high 1250 2500 --bit 3333 --frame-gap 10
+    DShot600      --high 625 1250 --bit 1667 --frame-gap 5
+    BDShot        add --inverted to the DShot line
+
+Use the `real*Nanoseconds` values in `PulseMath` for `--high` to check the code is doing what the math says, instead of
+what the protocol allows.
+
+The signal is named as it is in the VCD. A bit of a wider signal is picked with `NAME[bit]`.
+
+Exits non-zero if anything is out of tolerance or there are no pulses.
+"""
+
+import argparse
+import re
+import sys
+
+UNITS = {"s": 1e9, "ms": 1e6, "us": 1e3, "ns": 1, "ps": 1e-3, "fs": 1e-6}
+
+
+def parse(path, name):
+    """
+    @return (list of (time in ns, level) for every change of the signal, in order)
+    """
+    bit = None
+    m = re.match(r"^(.*)\[(\d+)\]$", name)
+    if m:
+        name, bit = m.group(1), int(m.group(2))
+
+    with open(path) as f:
+        text = f.read()
+
+    scale = 1.0
+    m = re.search(r"\$timescale\s+(\d+)\s*(\w+)\s+\$end", text)
+    if m:
+        scale = int(m.group(1)) * UNITS[m.group(2)]
+
+    ident = None
+    for m in re.finditer(r"\$var\s+\S+\s+\d+\s+(\S+)\s+(\S+)(?:\s+\[[^\]]*\])?\s+\$end", text):
+        if m.group(2) == name:
+            ident = m.group(1)
+            break
+
+    if ident is None:
+        raise SystemExit("no signal named %s in %s" % (name, path))
+
+    body = text[text.find("$enddefinitions"):]
+
+    changes = []
+    time = 0
+    level = None
+
+    for token in re.finditer(r"#(\d+)|b([01xzXZ]+)\s+(\S+)|([01xzXZ])(\S+)", body):
+        if token.group(1) is not None:
+            time = int(token.group(1)) * scale
+            continue
+
+        if token.group(2) is not None:
+            if token.group(3) != ident:
+                continue
+            value = token.group(2).lower()
+            if bit is None:
+                bit = 0
+            # Leading 0s are left off. Leading x and z stand for as many more of themselves.
+            value = value[-bit - 1] if bit < len(value) else value[0] if value[0] in "xz" else "0"
+        else:
+            if token.group(5) != ident:
+                continue
+            value = token.group(4).lower()
+
+        if value not in "01":
+            continue
+        new = value == "1"
+        if new != level:
+            level = new
+            changes.append((time, level))
+
+    return changes
+
+
+class Stat:
+    def __init__(self, what, expected, tolerance=None, minimum=None, unit=1):
+        self.what = what
+        self.expected = expected
+        self.tolerance = tolerance
+        self.minimum = minimum
+        self.unit = unit
+        self.values = []
+
+    def ok(self):
+        if not self.values:
+            return True
+        if self.tolerance is not None:
+            return all(abs(v - self.expected) <= self.tolerance for v in self.values)
+        if self.minimum is not None:
+            return min(self.values) >= self.minimum
+        return True
+
+    def row(self, note=""):
+        if self.tolerance is not None:
+            expected = "%g +-%g" % (self.expected, self.tolerance)
+        elif self.minimum is not None:
+            expected = ">= %g" % self.minimum
+        else:
+            expected = "-"
+        if self.values:
+            low, high = min(self.values) / self.unit, max(self.values) / self.unit
+            fmt = "%8.3f" if self.unit > 1 else "%8.1f"
+            values = (fmt + " " + fmt) % (low, high)
+        else:
+            values = "%8s %8s" % ("-", "-")
+        return "%-12s %12s %6d %s  %s" % (self.what, expected, len(self.values), values, note or
+                                          ("ok" if self.ok() else "FAIL"))
+
+
+def expected_bits(data):
+    return [(byte >> (7 - i)) & 1 for byte in data for i in range(8)]
+
+
+def measure(changes, args):
+    asserted = not args.inverted
+
+    if args.expect:
+        if len(args.high) != 2:
+            raise SystemExit("--expect needs two --high times, for \"0\" and \"1\"")
+        expect = expected_bits(args.expect)
+        highs = [Stat("high %s" % b, h, args.tolerance) for b, h in zip("01", args.high)]
+    else:
+        expect = None
+        highs = [Stat("high", h, args.tolerance) for h in args.high]
+    lows = Stat("low", None, minimum=args.low_min)
+    period = Stat("bit period", args.bit, args.bit_tolerance) if args.bit else None
+    frames = Stat("frame", None, unit=1e3)
+    bits = []
+    # Frames with the wrong number of bits, with --expect
+    wrong = 0
+
+    gap = args.frame_gap * 1e3
+    start = None
+    count = 0
+    last_rise = None
+
+    # A pulse already going when the trace starts, like an inverted line before it's set up, can't be measured
+    if changes and changes[0][1] == asserted:
+        changes = changes[1:]
+
+    # Pairs of (edge, next edge)
+    for (t, level), (t2, _) in zip(changes, changes[1:]):
+        width = t2 - t
+
+        if level == asserted:
+            if start is None:
+                start, count, last_rise = t, 0, None
+            if expect is None:
+                min(highs, key=lambda s: abs(s.expected - width)).values.append(width)
+            elif count < len(expect):
+                highs[expect[count]].values.append(width)
+            if period and last_rise is not None:
+                period.values.append(t - last_rise)
+            last_rise = t
+            count += 1
+            continue
+
+        if start is None:
+            continue
+
+        if width > gap:
+            frames.values.append(t - start)
+            bits.append(count)
+            wrong += expect is not None and count != len(expect)
+            start = None
+            continue
+
+        lows.values.append(width)
+
+    # The trace ended before the gap did
+    if start is not None:
+        frames.values.append(changes[-1][0] - start)
+        bits.append(count)
+        wrong += expect is not None and count != len(expect)
+
+    stats = highs + [lows] + ([period] if period else [])
+
+    print("%-12s %12s %6s %8s %8s  %s" % ("what", "expected", "count", "min", "max", "ok"))
+    for s in stats:
+        print(s.row())
+
+    note = "us, %s bits" % "/".join(map(str, sorted(set(bits)))) if bits else "us"
+    if expect is not None:
+        note += ", expected %d" % len(expect) + (", %d wrong" % wrong if wrong else "")
+    print(frames.row(note if not wrong else note + "  FAIL"))
+
+    found = any(s.values for s in highs)
+    return 0 if found and not wrong and all(s.ok() for s in stats) else 1
+
+
+def main(argv):
+    p = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    p.add_argument("vcd")
+    p.add_argument("signal")
+    p.add_argument("--high", type=float, nargs="+", required=True, help="high times, ns")
+    p.add_argument("--tolerance", type=float, default=150, help="for high times, ns (150)")
+    p.add_argument("--low-min", type=float, default=0, help="shortest low inside a frame, ns (0)")
+    p.add_argument("--bit", type=float, help="bit period, start to start, ns")
+    p.add_argument("--bit-tolerance", type=float, default=600, help="for the bit period, ns (600)")
+    p.add_argument("--frame-gap", type=float, default=50, help="lows longer than this end a frame, us (50)")
+    p.add_argument("--inverted", action="store_true", help="the line idles high, like BDShot")
+    p.add_argument("--expect", type=lambda v: int(v, 16), nargs="+", help="the bytes of every frame, hex")
+    args = p.parse_args(argv[1:])
+
+    return measure(parse(args.vcd, args.signal), args)
+
+
+if __name__ == "__main__":
+    sys.exit(main(sys.argv))
@@ -0,0 +1,108 @@
+#!/bin/sh
+# Run known frames through simavr for every protocol, Speed, and F_CPU, and check each pulse with pulse-timing.py.
+#
+# Usage: tools/pulse-timing.sh [F_CPU...]  (8000000 12000000 16000000 20000000)
+#
+# Prints one row per case. Details of any failure follow the table. A case the library rejects at compile time, with a
+# static_assert, is n/a. Needs avr-g++ and simavr on the PATH. CXXFLAGS, SIMAVR_INCLUDE (the directory that holds
+# simavr/avr/avr_mcu_section.h), and OUT (a directory for the builds and traces) can be overridden.
+#
+# BDShot is checked as its inverted DShot output. Each DShot bit has to be within BitTolerance of the nominal bit.
+
+set -e
+
+cd "$(dirname "$0")/.."
+
+CXXFLAGS=${CXXFLAGS:--Os -std=gnu++17}
+SIMAVR_INCLUDE=${SIMAVR_INCLUDE:-/usr/include}
+OUT=${OUT:-$(mktemp -d)}
+
+[ $# -gt 0 ] || set -- 8000000 12000000 16000000 20000000
+
+# Pixels with mixed bits in both nibbles, including all 0s and all 1s
+FRAME="0x5a 0x0f 0xc3 0x00 0xff 0x81"
+DSHOT_VALUE=998
+
+failed=0
+failures=""
+
+# protocol, case name, compiler flags, pulse-timing.py arguments
+run() {
+  dir="$OUT/$2"
+  mkdir -p "$dir"
+
+  if ! avr-g++ -mmcu=atmega32u4 -DF_CPU="${f}UL" $CXXFLAGS -I. -I"$SIMAVR_INCLUDE" $3 \
+    -Wl,--section-start=.mmcu=0x910000 tools/pulse-timing-firmware.cpp -o "$dir/firmware.elf" \
+    >"$dir/build.txt" 2>&1; then
+    if grep -q "static assertion failed" "$dir/build.txt"; then
+      result=n/a
+    else
+      result="FAIL build"
+    fi
+  elif ! (cd "$dir" && timeout 60 simavr firmware.elf) >"$dir/simavr.txt" 2>&1; then
+    result="FAIL simavr"
+  elif tools/pulse-timing.py "$dir/pulse-timing.vcd" PB0 $4 >"$dir/timing.txt" 2>&1; then
+    result=ok
+  else
+    result=FAIL
+  fi
+
+  printf "%-13s %-10s %9s  %s\n" "$1" "$speed" "$f" "$result"
+
+  case $result in
+  FAIL*)
+    failed=1
+    failures="$failures $dir"
+    ;;
+  esac
+}
+
+# Bytes on the wire for DSHOT_VALUE, without telemetry, like Command
+dshotFrame() {
+  raw=$((DSHOT_VALUE + 48))
+  c=$((raw << 1))
+  crc=$(((c ^ (c >> 4) ^ (c >> 8)) & 0xf))
+  [ "$1" = 0 ] || crc=$((crc ^ 0xf))
+  bits=$((raw << 5 | crc))
+  printf "%02x %02x" $((bits >> 8)) $((bits & 0xff))
+}
+
+printf "%-13s %-10s %9s  %s\n" protocol speed F_CPU result
+
+for f in "$@"; do
+  speed=-
+  expect=$(echo "$FRAME" | sed 's/0x//g')
+  for strict in 0 1; do
+    name=WS2812
+    [ $strict = 0 ] || name="WS2812 strict"
+    run "$name" "ws2812-$strict-$f" "-DWS2812_STRICT=$strict -DFRAME=$(echo "$FRAME" | tr ' ' ,)" \
+      "--high 400 800 --tolerance 150 --frame-gap 50 --expect $expect"
+  done
+
+  for speed in DSHOT150 DSHOT300 DSHOT600 DSHOT1200; do
+    case $speed in
+    DSHOT150) short=2500 ;;
+    DSHOT300) short=1250 ;;
+    DSHOT600) short=625 ;;
+    DSHOT1200) short=313 ;;
+    esac
+    bit=$((short * 8 / 3))
+
+    for inverted in 0 1; do
+      name=DShot
+      [ $inverted = 0 ] || name=BDShot
+      flags="--high $short $((short * 2)) --tolerance $((short / 5)) --bit $bit --bit-tolerance $((bit / 4))"
+      [ $inverted = 0 ] || flags="$flags --inverted"
+      run $name "$name-$speed-$f" "-DDSHOT_SPEED=$speed -DDSHOT_INVERTED=$inverted -DDSHOT_VALUE=$DSHOT_VALUE" \
+        "$flags --frame-gap 20 --expect $(dshotFrame $inverted)"
+    done
+  done
+done
+
+for dir in $failures; do
+  echo
+  echo "== $dir"
+  cat "$dir"/*.txt
+done
+
+exit $failed